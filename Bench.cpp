@@ -0,0 +1,20 @@
+#include "Bench.hpp"
+
+int main(int argc, char* argv[]) {
+  // Optional substring filter, eg. `efl-core-bench xthread`.
+  if(argc > 1)
+    bench_filter = argv[1];
+  allocator_bench();
+  deferred_bench();
+  hash_bench();
+  strref_bench();
+  flatmap_bench();
+  interner_bench();
+  enum_bench();
+  handle_bench();
+  ringbuf_bench();
+  spsc_bench();
+  mpmc_bench();
+  box_bench();
+  vec_bench();
+}
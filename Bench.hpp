@@ -0,0 +1,976 @@
+#include <efl/Core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace C = efl::core;
+namespace HH = efl::core::H;
+
+using BenchClock = std::chrono::steady_clock;
+
+//=== Harness ===//
+
+struct BenchConfig {
+  C::usize warmup = 2;
+  C::usize reps = 15;
+};
+
+/// Per-operation timings over every repetition, in nanoseconds.
+struct BenchResult {
+  double median = 0.0;
+  double p99 = 0.0;
+  double min = 0.0;
+};
+
+/// Only benchmarks containing this are run, set from `argv[1]`.
+static const char* bench_filter = nullptr;
+
+/// Stops the optimizer from discarding `t`.
+template <typename T>
+ALWAYS_INLINE void do_not_optimize(T& t) {
+  __asm__ __volatile__("" : : "r,m"(t) : "memory");
+}
+
+inline bool bench_enabled(const char* name) {
+  return !bench_filter || std::strstr(name, bench_filter);
+}
+
+inline void print_bench_header(const char* suite) {
+  std::cout << "\n=== " << suite << " ===\n"
+    << std::left << std::setw(44) << "benchmark"
+    << std::right << std::setw(12) << "median"
+    << std::setw(12) << "p99"
+    << std::setw(12) << "min" << "  (ns/op)\n";
+}
+
+/// Runs `fn()` `warmup + reps` times. Each run performs `ops`
+/// operations, and the timings of the repetitions are reported.
+template <typename F>
+BenchResult run_bench(const char* name, C::usize ops,
+ F&& fn, BenchConfig config = {}) {
+  BenchResult result {};
+  if(!bench_enabled(name)) return result;
+  for(C::usize I = 0; I < config.warmup; ++I)
+    fn();
+
+  C::Vec<double> samples {};
+  samples.reserve(config.reps);
+  for(C::usize I = 0; I < config.reps; ++I) {
+    const auto start = BenchClock::now();
+    fn();
+    const auto end = BenchClock::now();
+    const double ns = double(std::chrono::duration_cast<
+      std::chrono::nanoseconds>(end - start).count());
+    samples.push_back(ns / double(ops));
+  }
+
+  std::sort(samples.begin(), samples.end());
+  const C::usize n = samples.size();
+  result.median = (n % 2) ? samples[n / 2]
+    : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+  result.p99 = samples[(n * 99 + 99) / 100 - 1];
+  result.min = samples.front();
+
+  std::cout << std::left << std::setw(44) << name
+    << std::right << std::fixed << std::setprecision(2)
+    << std::setw(12) << result.median
+    << std::setw(12) << result.p99
+    << std::setw(12) << result.min << '\n';
+  return result;
+}
+
+/// Prints the median of `result` as operations per second.
+inline void print_throughput(const BenchResult& result) {
+  if(result.median <= 0.0) return;
+  std::cout << std::left << std::setw(44) << "  -> Mops/s"
+    << std::right << std::fixed << std::setprecision(2)
+    << std::setw(12) << (1000.0 / result.median) << '\n';
+}
+
+//=== Allocator Adaptors ===//
+
+/// Allocates through `std::allocator_traits<A>`.
+template <typename A>
+struct StdAdaptor {
+  using value_type = typename A::value_type;
+  static value_type* Allocate(C::usize n) {
+    A alloc {};
+    return std::allocator_traits<A>::allocate(alloc, n);
+  }
+  static void Deallocate(value_type* p, C::usize n) {
+    A alloc {};
+    std::allocator_traits<A>::deallocate(alloc, p, n);
+  }
+};
+
+/// Allocates through the static `Allocate`/`Deallocate`.
+template <typename A>
+struct StaticAdaptor {
+  using value_type = typename A::value_type;
+  static value_type* Allocate(C::usize n) {
+    return A::Allocate(n);
+  }
+  static void Deallocate(value_type* p, C::usize n) {
+    A::Deallocate(p, n);
+  }
+};
+
+struct SmallObj { C::u64 data[4]; };
+struct alignas(64) AlignedObj { C::u64 data[8]; };
+
+//=== Allocator Suite ===//
+
+/// Allocates `count` blocks of `n` objects, then frees them.
+template <typename Adaptor>
+void alloc_free_bench(const char* name, C::usize count, C::usize n) {
+  using T = typename Adaptor::value_type;
+  C::Vec<T*> ptrs(count);
+  run_bench(name, count, [&] {
+    for(C::usize I = 0; I < count; ++I)
+      ptrs[I] = Adaptor::Allocate(n);
+    do_not_optimize(ptrs.back());
+    for(C::usize I = 0; I < count; ++I)
+      Adaptor::Deallocate(ptrs[I], n);
+  });
+}
+
+/// Allocates on one thread, and frees on another.
+template <typename Adaptor>
+void cross_thread_bench(const char* name, C::usize count, C::usize n) {
+  using T = typename Adaptor::value_type;
+  C::Vec<T*> ptrs(count);
+  run_bench(name, count, [&] {
+    std::thread producer([&] {
+      for(C::usize I = 0; I < count; ++I)
+        ptrs[I] = Adaptor::Allocate(n);
+    });
+    producer.join();
+    std::thread consumer([&] {
+      for(C::usize I = 0; I < count; ++I)
+        Adaptor::Deallocate(ptrs[I], n);
+    });
+    consumer.join();
+  });
+}
+
+void allocator_bench() {
+  constexpr C::usize small_count = 1 << 16;
+  constexpr C::usize large_count = 1 << 10;
+  constexpr C::usize large_n = 64 * 1024;
+  print_bench_header("Allocators");
+
+  using StdSmall = StdAdaptor<std::allocator<SmallObj>>;
+  using MimSmall = StdAdaptor<C::MimAllocator<SmallObj>>;
+  using StatelessSmall = StaticAdaptor<C::StatelessMimAllocator<SmallObj>>;
+  alloc_free_bench<StdSmall>("small/std::allocator", small_count, 1);
+  alloc_free_bench<MimSmall>("small/MimAllocator", small_count, 1);
+  alloc_free_bench<StatelessSmall>(
+    "small/StatelessMimAllocator", small_count, 1);
+
+  using StdLarge = StdAdaptor<std::allocator<C::ubyte>>;
+  using MimLarge = StdAdaptor<C::MimAllocator<C::ubyte>>;
+  alloc_free_bench<StdLarge>("large/std::allocator", large_count, large_n);
+  alloc_free_bench<MimLarge>("large/MimAllocator", large_count, large_n);
+
+  using StdAligned = StdAdaptor<std::allocator<AlignedObj>>;
+  using MimAligned = StdAdaptor<C::MimAllocator<AlignedObj>>;
+  using MimOveraligned = StdAdaptor<C::MimAllocator<SmallObj, 64>>;
+  alloc_free_bench<StdAligned>("aligned/std::allocator", small_count, 1);
+  alloc_free_bench<MimAligned>("aligned/MimAllocator", small_count, 1);
+  alloc_free_bench<MimOveraligned>(
+    "aligned/MimAllocator<T, 64>", small_count, 1);
+
+  cross_thread_bench<StdSmall>("xthread/small/std::allocator", small_count, 1);
+  cross_thread_bench<MimSmall>("xthread/small/MimAllocator", small_count, 1);
+  cross_thread_bench<StatelessSmall>(
+    "xthread/small/StatelessMimAllocator", small_count, 1);
+  cross_thread_bench<StdLarge>(
+    "xthread/large/std::allocator", large_count, large_n);
+  cross_thread_bench<MimLarge>(
+    "xthread/large/MimAllocator", large_count, large_n);
+}
+
+//=== Deferred Free Suite ===//
+
+/// Reusable barrier for two threads.
+struct BenchBarrier {
+  void wait() {
+    const C::usize gen = gen_.load(std::memory_order_acquire);
+    if(count_.fetch_add(1, std::memory_order_acq_rel) == 1) {
+      count_.store(0, std::memory_order_relaxed);
+      gen_.store(gen + 1, std::memory_order_release);
+      return;
+    }
+    while(gen_.load(std::memory_order_acquire) == gen)
+      std::this_thread::yield();
+  }
+public:
+  std::atomic<C::usize> count_ { 0 };
+  std::atomic<C::usize> gen_ { 0 };
+};
+
+/// Each round, both threads allocate messages and free the ones
+/// the other thread allocated in the previous round.
+template <bool Deferred>
+void ping_pong_bench(const char* name) {
+  using Alloc = C::MimAllocator<SmallObj>;
+  constexpr C::usize rounds = 64;
+  constexpr C::usize count = 1024;
+  C::Vec<SmallObj*> msgs[2] { C::Vec<SmallObj*>(count), 
+    C::Vec<SmallObj*>(count) };
+  run_bench(name, rounds * count * 2, [&] {
+    BenchBarrier barrier {};
+    auto worker = [&](C::usize id) {
+      C::collect_deferred_frees();
+      barrier.wait();
+      for(C::usize R = 0; R < rounds; ++R) {
+        for(SmallObj*& P : msgs[id])
+          P = Alloc::allocate(1);
+        barrier.wait();
+        for(SmallObj* P : msgs[id ^ 1]) {
+          if(Deferred)
+            Alloc::deallocate_deferred(P, 1);
+          else
+            Alloc::deallocate(P, 1);
+        }
+        if(Deferred) {
+          C::flush_deferred_frees();
+          C::collect_deferred_frees();
+        }
+        barrier.wait();
+      }
+      C::collect_deferred_frees();
+    };
+    std::thread other(worker, 1);
+    worker(0);
+    other.join();
+  });
+}
+
+void deferred_bench() {
+  print_bench_header("Deferred Free");
+  ping_pong_bench<false>("ping_pong/deallocate");
+  ping_pong_bench<true>("ping_pong/deallocate_deferred");
+}
+
+//=== Hash Suite ===//
+
+void int_hash_bench() {
+  constexpr C::usize count = 1 << 20;
+  run_bench("u64/std::hash", count, [] {
+    C::usize h = 0;
+    for(C::u64 I = 0; I < count; ++I)
+      h ^= std::hash<C::u64>{}(I * 0x9E3779B97F4A7C15ULL);
+    do_not_optimize(h);
+  });
+  run_bench("u64/Hash", count, [] {
+    C::usize h = 0;
+    for(C::u64 I = 0; I < count; ++I)
+      h ^= C::Hash<C::u64>{}(I * 0x9E3779B97F4A7C15ULL);
+    do_not_optimize(h);
+  });
+}
+
+/// Hashes every `len` byte window of a buffer.
+void str_hash_bench(C::usize len) {
+  const C::usize count = (len < 1024) ? (1 << 16) : (1 << 8);
+  C::Str buf(len + 64, 'x');
+  for(C::usize I = 0; I < buf.size(); ++I)
+    buf[I] = char('a' + (I * 7) % 26);
+  char name[64];
+  std::snprintf(name, sizeof(name), "str[%zu]/std::hash", len);
+  run_bench(name, count, [&] {
+    C::usize h = 0;
+    for(C::usize I = 0; I < count; ++I) {
+      std::string_view view(buf.data() + (I & 63), len);
+      h ^= std::hash<std::string_view>{}(view);
+    }
+    do_not_optimize(h);
+  });
+  std::snprintf(name, sizeof(name), "str[%zu]/Hash", len);
+  run_bench(name, count, [&] {
+    C::usize h = 0;
+    for(C::usize I = 0; I < count; ++I) {
+      C::StrRef str(buf.data() + (I & 63), len);
+      h ^= C::Hash<C::StrRef>{}(str);
+    }
+    do_not_optimize(h);
+  });
+}
+
+void hash_bench() {
+  print_bench_header("Hash");
+  int_hash_bench();
+  for(C::usize len : { 8, 32, 256, 4096, 65536 })
+    str_hash_bench(len);
+}
+
+//=== FlatMap Suite ===//
+
+/// Spreads sequential keys so neither table sees an easy pattern.
+inline C::u64 bench_key(C::u64 I) {
+  return I * 0x9E3779B97F4A7C15ULL;
+}
+
+/// Visits `[0, n)` out of insertion order, so node based
+/// tables don't get free locality from their allocator.
+inline C::u64 bench_shuffle(C::u64 I, C::usize n) {
+  return (I * 7919) & (n - 1);
+}
+
+template <typename MapType>
+void map_ops_bench(const char* table, C::usize n) {
+  char name[64];
+  std::snprintf(name, sizeof(name), "insert[%zu]/%s", n, table);
+  run_bench(name, n, [n] {
+    MapType map {};
+    for(C::u64 I = 0; I < n; ++I)
+      map[bench_key(I)] = I;
+    C::usize size = map.size();
+    do_not_optimize(size);
+  });
+  MapType map {};
+  for(C::u64 I = 0; I < n; ++I)
+    map[bench_key(I)] = I;
+  std::snprintf(name, sizeof(name), "hit[%zu]/%s", n, table);
+  run_bench(name, n, [&] {
+    C::u64 sum = 0;
+    for(C::u64 I = 0; I < n; ++I)
+      sum += map.find(bench_key(bench_shuffle(I, n)))->second;
+    do_not_optimize(sum);
+  });
+  std::snprintf(name, sizeof(name), "miss[%zu]/%s", n, table);
+  run_bench(name, n, [&] {
+    C::usize misses = 0;
+    for(C::u64 I = n; I < 2 * n; ++I)
+      misses += (map.find(bench_key(I)) == map.end());
+    do_not_optimize(misses);
+  });
+  std::snprintf(name, sizeof(name), "churn[%zu]/%s", n, table);
+  run_bench(name, n, [&] {
+    for(C::u64 I = 0; I < n; ++I) {
+      map.erase(bench_key(I));
+      map[bench_key(I)] = I;
+    }
+    C::usize size = map.size();
+    do_not_optimize(size);
+  });
+}
+
+/// Looks up `Str` keys through a borrowed view.
+/// Both tables own their keys, the probes are separate copies.
+void str_map_bench(C::usize n) {
+  C::Vec<C::Str> probes {};
+  for(C::usize I = 0; I < n; ++I) {
+    probes.emplace_back("key/");
+    probes.back() += std::to_string(bench_key(I));
+  }
+  std::unordered_map<std::string, C::usize> std_map {};
+  C::FlatMap<C::Str, C::usize> flat_map {};
+  for(C::usize I = 0; I < n; ++I) {
+    std_map[std::string(probes[I])] = I;
+    flat_map[probes[I]] = I;
+  }
+  char name[64];
+  std::snprintf(name, sizeof(name), "str_hit[%zu]/std", n);
+  run_bench(name, n, [&] {
+    C::usize sum = 0;
+    for(C::usize I = 0; I < n; ++I) {
+      const C::Str& key = probes[bench_shuffle(I, n)];
+      // Needs a temporary, no heterogeneous lookup before C++20.
+      sum += std_map.find(std::string(key))->second;
+    }
+    do_not_optimize(sum);
+  });
+  std::snprintf(name, sizeof(name), "str_hit[%zu]/FlatMap", n);
+  run_bench(name, n, [&] {
+    C::usize sum = 0;
+    for(C::usize I = 0; I < n; ++I) {
+      const C::Str& key = probes[bench_shuffle(I, n)];
+      sum += flat_map.find(C::StrRef(key))->second;
+    }
+    do_not_optimize(sum);
+  });
+}
+
+void flatmap_bench() {
+  using StdMap = std::unordered_map<C::u64, C::u64>;
+  using FlatMap = C::FlatMap<C::u64, C::u64>;
+  print_bench_header("FlatMap");
+  for(C::usize n : { 1 << 10, 1 << 16, 1 << 20 }) {
+    map_ops_bench<StdMap>("std", n);
+    map_ops_bench<FlatMap>("FlatMap", n);
+  }
+  str_map_bench(1 << 16);
+}
+
+//=== Interner Suite ===//
+
+template <typename Interner>
+void intern_bench(const char* name, const C::Vec<C::Str>& strs) {
+  Interner interner {};
+  for(const C::Str& str : strs)
+    (void) interner.intern(str);
+  run_bench(name, strs.size(), [&] {
+    C::u32 sum = 0;
+    for(const C::Str& str : strs)
+      sum += interner.intern(str).id();
+    do_not_optimize(sum);
+  });
+}
+
+void interner_bench() {
+  constexpr C::usize count = 4096;
+  C::Vec<C::Str> strs {};
+  for(C::usize I = 0; I < count; ++I) {
+    strs.emplace_back("config.identifier.");
+    strs.back() += std::to_string(I);
+  }
+  print_bench_header("Interner");
+  intern_bench<C::StrInterner>("intern/StrInterner", strs);
+  intern_bench<C::SyncStrInterner>("intern/SyncStrInterner", strs);
+  C::StrInterner interner {};
+  C::Vec<C::Symbol> syms {};
+  for(const C::Str& str : strs)
+    syms.push_back(interner.intern(str));
+  // Compares every string against its neighbour.
+  run_bench("eq/Str", count, [&] {
+    C::usize eq = 0;
+    for(C::usize I = 1; I < count; ++I)
+      eq += (strs[I] == strs[I - 1]);
+    do_not_optimize(eq);
+  });
+  run_bench("eq/Symbol", count, [&] {
+    C::usize eq = 0;
+    for(C::usize I = 1; I < count; ++I)
+      eq += (syms[I] == syms[I - 1]);
+    do_not_optimize(eq);
+  });
+}
+
+//=== RingBuf Suite ===//
+
+/// Keeps `depth` elements queued while streaming through.
+template <typename QueueType>
+void queue_stream_bench(const char* name, C::usize depth) {
+  constexpr C::usize count = 1 << 20;
+  run_bench(name, count, [depth] {
+    QueueType queue {};
+    C::u64 sum = 0;
+    for(C::u64 I = 0; I < count; ++I) {
+      queue.push_back(I);
+      if(queue.size() > depth) {
+        sum += queue.front();
+        queue.pop_front();
+      }
+    }
+    do_not_optimize(sum);
+  });
+}
+
+/// Pushes and pops spans of bytes, like an outbound buffer.
+void ring_bulk_bench() {
+  constexpr C::usize count = 1 << 16;
+  C::ubyte chunk[256] {};
+  C::ubyte out[256] {};
+  run_bench("bulk[256]/std::deque", count, [&] {
+    std::deque<C::ubyte> queue {};
+    for(C::usize I = 0; I < count; ++I) {
+      queue.insert(queue.end(), chunk, chunk + 256);
+      std::copy_n(queue.begin(), 256, out);
+      queue.erase(queue.begin(), queue.begin() + 256);
+    }
+    do_not_optimize(out[0]);
+  });
+  run_bench("bulk[256]/RingBuf", count, [&] {
+    C::RingBuf<C::ubyte> queue {};
+    for(C::usize I = 0; I < count; ++I) {
+      queue.pushBack(chunk);
+      (void) queue.popFront(out);
+    }
+    do_not_optimize(out[0]);
+  });
+}
+
+void ringbuf_bench() {
+  print_bench_header("RingBuf");
+  queue_stream_bench<std::deque<C::u64>>("stream[64]/std::deque", 64);
+  queue_stream_bench<C::RingBuf<C::u64>>("stream[64]/RingBuf", 64);
+  queue_stream_bench<std::deque<C::u64>>(
+    "stream[64k]/std::deque", 1 << 16);
+  queue_stream_bench<C::RingBuf<C::u64>>(
+    "stream[64k]/RingBuf", 1 << 16);
+  ring_bulk_bench();
+}
+
+//=== Queue Suite ===//
+
+/// Spins, then yields, then sleeps. `sched_yield` alone can keep
+/// the waiter running for a whole timeslice on a single core.
+struct BenchBackoff {
+  void wait() {
+    if(++this->fails_ < 64)
+      std::this_thread::yield();
+    else
+      std::this_thread::sleep_for(std::chrono::microseconds(1));
+  }
+  void reset() { this->fails_ = 0; }
+public:
+  C::u32 fails_ = 0;
+};
+
+/// Baseline, what `SpscQueue` replaces.
+template <typename T>
+struct LockedDeque {
+  bool tryPush(const T& t) {
+    MEflLock(mtx_);
+    queue_.push_back(t);
+    return true;
+  }
+
+  bool tryPop(T& out) {
+    MEflLock(mtx_);
+    if(queue_.empty()) return false;
+    out = queue_.front();
+    queue_.pop_front();
+    return true;
+  }
+public:
+  C::Mtx mtx_;
+  std::deque<T> queue_;
+};
+
+template <typename Queue>
+void queue_throughput_bench(const char* name, Queue& queue) {
+  constexpr C::u64 count = 1 << 20;
+  const auto result = run_bench(name, count, [&queue] {
+    std::thread producer([&queue] {
+      BenchBackoff backoff {};
+      for(C::u64 I = 0; I < count; ++I) {
+        while(!queue.tryPush(I))
+          backoff.wait();
+        backoff.reset();
+      }
+    });
+    BenchBackoff backoff {};
+    C::u64 sum = 0, out = 0;
+    for(C::u64 I = 0; I < count; ++I) {
+      while(!queue.tryPop(out))
+        backoff.wait();
+      backoff.reset();
+      sum += out;
+    }
+    producer.join();
+    do_not_optimize(sum);
+  });
+  print_throughput(result);
+}
+
+template <C::usize Batch>
+void spsc_batch_bench(const char* name) {
+  constexpr C::u64 count = 1 << 20;
+  C::SpscQueue<C::u64> queue(1024);
+  const auto result = run_bench(name, count, [&queue] {
+    std::thread producer([&queue] {
+      BenchBackoff backoff {};
+      C::u64 batch[Batch] {};
+      for(C::u64 I = 0; I < count; I += Batch) {
+        for(C::usize J = 0; J < Batch; ++J)
+          batch[J] = I + J;
+        C::usize done = 0;
+        while(done < Batch) {
+          const C::usize n = queue.tryPushBatch(
+            C::ImmutArrayRef<C::u64>(batch + done, Batch - done));
+          if(n) backoff.reset();
+          else backoff.wait();
+          done += n;
+        }
+      }
+    });
+    BenchBackoff backoff {};
+    C::u64 sum = 0, popped = 0;
+    C::u64 outs[Batch] {};
+    while(popped < count) {
+      const C::usize n = queue.tryPopBatch(outs);
+      if(n) backoff.reset();
+      else backoff.wait();
+      for(C::usize J = 0; J < n; ++J)
+        sum += outs[J];
+      popped += n;
+    }
+    producer.join();
+    do_not_optimize(sum);
+  });
+  print_throughput(result);
+}
+
+/// Bounces a value between two threads, reports one-way latency.
+/// Dominated by the scheduler when there are fewer cores
+/// than threads.
+void spsc_latency_bench() {
+  constexpr C::u64 rounds = 1 << 14;
+  C::SpscQueue<C::u64> ping(64), pong(64);
+  run_bench("latency/SpscQueue", rounds * 2, [&] {
+    std::thread echo([&] {
+      BenchBackoff backoff {};
+      C::u64 value = 0;
+      for(C::u64 I = 0; I < rounds; ++I) {
+        while(!ping.tryPop(value))
+          backoff.wait();
+        backoff.reset();
+        (void) pong.tryPush(value + 1);
+      }
+    });
+    BenchBackoff backoff {};
+    C::u64 value = 0;
+    for(C::u64 I = 0; I < rounds; ++I) {
+      (void) ping.tryPush(value);
+      while(!pong.tryPop(value))
+        backoff.wait();
+      backoff.reset();
+    }
+    echo.join();
+    do_not_optimize(value);
+  });
+}
+
+void spsc_bench() {
+  print_bench_header("SpscQueue");
+  LockedDeque<C::u64> locked {};
+  queue_throughput_bench("handoff/Mtx+std::deque", locked);
+  C::SpscQueue<C::u64> queue(1024);
+  queue_throughput_bench("handoff/SpscQueue", queue);
+  spsc_batch_bench<32>("handoff/SpscQueue/batch[32]");
+  spsc_latency_bench();
+}
+
+/// Half the threads produce, half consume, `ops` in total.
+template <typename Push, typename Pop>
+void contention_bench(const char* name, C::usize threads,
+ Push push, Pop pop) {
+  constexpr C::u64 ops = 1 << 18;
+  const C::usize producers = (threads > 1) ? threads / 2 : 1;
+  const C::usize consumers = (threads > 1) ? threads - producers : 1;
+  const auto result = run_bench(name, ops, [&] {
+    if(threads == 1) {
+      for(C::u64 I = 0; I < ops; ++I) {
+        push(I);
+        C::u64 out = pop();
+        do_not_optimize(out);
+      }
+      return;
+    }
+    C::Vec<std::thread> pool {};
+    for(C::usize P = 0; P < producers; ++P) {
+      pool.emplace_back([&] {
+        for(C::u64 I = 0; I < ops / producers; ++I)
+          push(I);
+      });
+    }
+    for(C::usize Cn = 0; Cn < consumers; ++Cn) {
+      pool.emplace_back([&] {
+        C::u64 sum = 0;
+        for(C::u64 I = 0; I < ops / consumers; ++I)
+          sum += pop();
+        do_not_optimize(sum);
+      });
+    }
+    for(auto& thread : pool)
+      thread.join();
+  }, BenchConfig { 1, 5 });
+  print_throughput(result);
+}
+
+void mpmc_bench() {
+  print_bench_header("MpmcQueue");
+  char name[64];
+  for(C::usize threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+    LockedDeque<C::u64> locked {};
+    std::snprintf(name, sizeof(name), 
+      "contention[%zu]/Mtx+std::deque", threads);
+    contention_bench(name, threads, 
+      [&](C::u64 I) { (void) locked.tryPush(I); },
+      [&] {
+        BenchBackoff backoff {};
+        C::u64 out = 0;
+        while(!locked.tryPop(out))
+          backoff.wait();
+        return out;
+      });
+    C::MpmcQueue<C::u64> queue(1024);
+    std::snprintf(name, sizeof(name), 
+      "contention[%zu]/MpmcQueue", threads);
+    contention_bench(name, threads, 
+      [&](C::u64 I) { queue.push(I); },
+      [&] {
+        C::u64 out = 0;
+        queue.pop(out);
+        return out;
+      });
+  }
+}
+
+//=== Enum Suite ===//
+
+enum class BenchOp : C::u8 {
+  Add, Sub, Xor, Shl, Shr, Mul, Neg, Inc,
+  MEflEnumEnd(Inc)
+};
+
+using BenchOpFn = C::u64(*)(C::u64, C::u64);
+
+inline C::u64 op_add(C::u64 a, C::u64 b) { return a + b; }
+inline C::u64 op_sub(C::u64 a, C::u64 b) { return a - b; }
+inline C::u64 op_xor(C::u64 a, C::u64 b) { return a ^ b; }
+inline C::u64 op_shl(C::u64 a, C::u64 b) { return a << (b & 7); }
+inline C::u64 op_shr(C::u64 a, C::u64 b) { return a >> (b & 7); }
+inline C::u64 op_mul(C::u64 a, C::u64 b) { return a * (b | 1); }
+inline C::u64 op_neg(C::u64 a, C::u64)   { return ~a; }
+inline C::u64 op_inc(C::u64 a, C::u64)   { return a + 1; }
+
+/// Dispatches a pseudo-random opcode stream through each table.
+void enum_dispatch_bench() {
+  constexpr C::usize count = 1 << 20;
+  const BenchOpFn fns[] {
+    op_add, op_sub, op_xor, op_shl, 
+    op_shr, op_mul, op_neg, op_inc
+  };
+  C::Vec<BenchOp> ops(count);
+  for(C::usize I = 0; I < count; ++I)
+    ops[I] = BenchOp(bench_key(I) % 8);
+
+  std::unordered_map<BenchOp, BenchOpFn> map;
+  C::EnumArray<BenchOp, BenchOpFn> table {};
+  for(C::u8 I = 0; I < 8; ++I) {
+    map[BenchOp(I)] = fns[I];
+    table[BenchOp(I)] = fns[I];
+  }
+
+  run_bench("dispatch/std::unordered_map", count, [&] {
+    C::u64 acc = 1;
+    for(C::usize I = 0; I < count; ++I)
+      acc = map.find(ops[I])->second(acc, I);
+    do_not_optimize(acc);
+  });
+  run_bench("dispatch/EnumArray", count, [&] {
+    C::u64 acc = 1;
+    for(C::usize I = 0; I < count; ++I)
+      acc = table[ops[I]](acc, I);
+    do_not_optimize(acc);
+  });
+}
+
+void enum_bench() {
+  print_bench_header("Enum");
+  enum_dispatch_bench();
+}
+
+//=== Handle Suite ===//
+
+struct BenchEntity {
+  float pos[3];
+  float vel[3];
+  C::u32 flags;
+};
+
+/// Sums positions through handles in shuffled order, then as a scan.
+void entity_table_bench(C::usize n) {
+  char name[64];
+  C::Vec<C::Box<BenchEntity>> boxes;
+  C::HandlePool<BenchEntity> pool;
+  C::Vec<C::Handle<BenchEntity>> handles;
+  for(C::usize I = 0; I < n; ++I) {
+    const BenchEntity e { { float(I), 0, 0 }, { 1, 1, 1 }, 0 };
+    boxes.push_back(C::Box<BenchEntity>::New(e));
+    handles.push_back(pool.insert(e));
+  }
+  C::Vec<C::usize> order(n);
+  for(C::usize I = 0; I < n; ++I)
+    order[I] = bench_shuffle(I, n);
+
+  std::snprintf(name, sizeof(name), "lookup[%zu]/Box", n);
+  run_bench(name, n, [&] {
+    float sum = 0;
+    for(C::usize I : order)
+      sum += boxes[I]->pos[0];
+    do_not_optimize(sum);
+  });
+  std::snprintf(name, sizeof(name), "lookup[%zu]/HandlePool", n);
+  run_bench(name, n, [&] {
+    float sum = 0;
+    for(C::usize I : order)
+      sum += pool[handles[I]].pos[0];
+    do_not_optimize(sum);
+  });
+  std::snprintf(name, sizeof(name), "scan[%zu]/Box", n);
+  run_bench(name, n, [&] {
+    for(auto& e : boxes)
+      e->pos[0] += e->vel[0];
+    do_not_optimize(boxes);
+  });
+  std::snprintf(name, sizeof(name), "scan[%zu]/HandlePool", n);
+  run_bench(name, n, [&] {
+    for(BenchEntity& e : pool)
+      e.pos[0] += e.vel[0];
+    do_not_optimize(pool);
+  });
+}
+
+void handle_bench() {
+  print_bench_header("HandlePool");
+  for(C::usize n : { 1 << 10, 1 << 16, 1 << 20 })
+    entity_table_bench(n);
+}
+
+//=== StrRef Suite ===//
+
+/// Runs `fn(haystack)` over every `len` byte window of a text buffer,
+/// for both views, where the searched for bytes never occur.
+template <typename SvFn, typename StrFn>
+void str_search_bench(const char* op, C::usize len, 
+ SvFn sv_fn, StrFn str_fn) {
+  const C::usize count = (len < 1024) ? (1 << 16) : (1 << 8);
+  static C::Str buf;
+  if(buf.size() < len + 64) {
+    buf.assign(len + 64, ' ');
+    for(C::usize I = 0; I < buf.size(); ++I)
+      buf[I] = char('a' + (bench_key(I) >> 59) % 24);
+  }
+  char name[64];
+  std::snprintf(name, sizeof(name), "%s[%zu]/string_view", op, len);
+  run_bench(name, count, [&] {
+    C::usize h = 0;
+    for(C::usize I = 0; I < count; ++I)
+      h += sv_fn(std::string_view(buf.data() + (I & 63), len));
+    do_not_optimize(h);
+  });
+  std::snprintf(name, sizeof(name), "%s[%zu]/StrRef", op, len);
+  run_bench(name, count, [&] {
+    C::usize h = 0;
+    for(C::usize I = 0; I < count; ++I)
+      h += str_fn(C::StrRef(buf.data() + (I & 63), len));
+    do_not_optimize(h);
+  });
+}
+
+/// Splits CSV records into fields, by copying and by view.
+void split_bench() {
+  constexpr C::usize rows = 1 << 12;
+  C::Str text;
+  for(C::usize I = 0; I < rows; ++I) {
+    text += "2024-06-01T12:00:00,INFO,worker-";
+    text += std::to_string(I % 64);
+    text += ",request handled,path=/api/v1/items,status=200\n";
+  }
+  const C::StrRef csv(text);
+  run_bench("split/Vec<Str>", rows, [&] {
+    C::usize total = 0;
+    for(C::StrRef line : csv.lines()) {
+      C::Vec<C::Str> fields;
+      C::usize start = 0;
+      for(C::usize I = 0; I <= line.size(); ++I) {
+        if(I == line.size() || line[I] == ',') {
+          fields.emplace_back(line.data() + start, I - start);
+          start = I + 1;
+        }
+      }
+      total += fields.size();
+    }
+    do_not_optimize(total);
+  });
+  run_bench("split/StrRef", rows, [&] {
+    C::usize total = 0;
+    for(C::StrRef line : csv.lines()) {
+      C::SmallVec<C::StrRef, 8> fields;
+      total += line.split(',').collect(fields);
+    }
+    do_not_optimize(total);
+  });
+}
+
+void strref_bench() {
+  print_bench_header("StrRef");
+  split_bench();
+  const C::CharSet ws(" \t\r\n");
+  for(C::usize len : { 64, 4096, 65536 }) {
+    str_search_bench("find(char)", len, 
+      [](std::string_view sv) { return sv.find('z'); },
+      [](C::StrRef str) { return str.find('z'); });
+    str_search_bench("rfind(char)", len, 
+      [](std::string_view sv) { return sv.rfind('z'); },
+      [](C::StrRef str) { return str.rfind('z'); });
+    str_search_bench("find(str)", len, 
+      [](std::string_view sv) { return sv.find("abcz"); },
+      [](C::StrRef str) { return str.find("abcz"); });
+    str_search_bench("findFirstOf", len, 
+      [](std::string_view sv) { return sv.find_first_of(" \t\r\n"); },
+      [&](C::StrRef str) { return str.findFirstOf(ws); });
+    str_search_bench("count(char)", len, 
+      [](std::string_view sv) { 
+        return C::usize(std::count(sv.begin(), sv.end(), 'a')); },
+      [](C::StrRef str) { return str.count('a'); });
+  }
+}
+
+//=== Box Suite ===//
+
+struct BenchNode {
+  BenchNode(C::usize v) : value(v) { }
+  C::usize value;
+  BenchNode* next = nullptr;
+  BenchNode* prev = nullptr;
+};
+
+template <typename BoxType, typename F>
+void box_churn_bench(const char* name, F make) {
+  constexpr C::usize count = 1 << 16;
+  C::Vec<BoxType> boxes {};
+  boxes.reserve(count);
+  run_bench(name, count, [&] {
+    for(C::usize I = 0; I < count; ++I)
+      boxes.push_back(make(I));
+    do_not_optimize(boxes.back()->value);
+    boxes.clear();
+  });
+}
+
+void box_bench() {
+  using PoolBox = C::Box<BenchNode, C::PoolBoxAllocator<BenchNode>>;
+  print_bench_header("Box");
+  box_churn_bench<std::unique_ptr<BenchNode>>("churn/std::unique_ptr",
+    [](C::usize I) { return std::unique_ptr<BenchNode>(new BenchNode(I)); });
+  box_churn_bench<C::Box<BenchNode>>("churn/BoxAllocator",
+    [](C::usize I) { return C::Box<BenchNode>::New(I); });
+  box_churn_bench<PoolBox>("churn/PoolBoxAllocator",
+    [](C::usize I) { return PoolBox::New(I); });
+}
+
+//=== Vec Suite ===//
+
+template <typename VecType>
+void vec_fill_bench(const char* name) {
+  constexpr C::usize count = 1 << 20;
+  run_bench(name, count, [] {
+    VecType vec {};
+    for(C::usize I = 0; I < count; ++I)
+      vec.push_back(float(I));
+    do_not_optimize(vec.back());
+  });
+}
+
+void vec_bench() {
+  print_bench_header("Vec");
+  vec_fill_bench<std::vector<float>>("push_back/std::vector");
+  vec_fill_bench<C::Vec<float>>("push_back/Vec");
+  vec_fill_bench<C::OveralignedVec<float, 64>>("push_back/OveralignedVec<64>");
+  vec_fill_bench<C::RelocVec<float>>("push_back/RelocVec");
+}
@@ -22,6 +22,14 @@ namespace C {
 } // namespace C
 } // namespace efl
 
+struct TestMimConfig {
+  C::MimConfig operator()() const {
+    return C::MimConfig().purgeDelay(25);
+  }
+};
+
+MEflMimConfig(TestMimConfig);
+
 struct ToApply {
 private:
   template <typename T>
@@ -115,9 +123,31 @@ int main() {
   invoke_tests();
   ref_tests();
   strref_tests();
+  strref_search_tests();
+  strref_split_tests();
   poly_tests();
   assert(result_tests() == 0);
   array_tests();
   arrayref_tests();
+  allocator_tests();
+  stats_tests();
+  relocvec_tests();
+  smallvec_tests();
+  hash_tests();
+  enum_array_tests();
+  flagset_tests();
+  flatmap_tests();
+  handle_tests();
+  interner_tests();
+  ringbuf_tests();
+  spsc_tests();
+  mpmc_tests();
+  config_tests();
+  heap_tests();
+  arena_tests();
+  numa_tests();
+  scope_tests();
+  pool_tests();
+  deferred_tests();
   return option_tests();
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <efl/Core.hpp>
 #include <iostream>
+#include <thread>
 
 namespace C = efl::core;
 namespace HH = efl::core::H;
@@ -117,6 +118,121 @@ void strref_tests() {
   MEflESAssert(sl[0] == 'l' && sl[1] == 'l');
 }
 
+void strref_search_tests() {
+#if CPPVER_LEAST(14)
+ /* Constexpr */ {
+  constexpr C::StrRef str("key=value; key2=value2");
+  MEflESAssert(str.findSlow('=') == 3);
+  MEflESAssert(str.findSlow("key2") == 11);
+  MEflESAssert(str.findSlow("key", 1) == 11);
+  MEflESAssert(str.findSlow("nope") == C::StrRef::npos);
+  MEflESAssert(C::CharSet(";=").contains('='));
+  MEflESAssert(!C::CharSet::Range('a', 'z').contains('A'));
+ }
+#endif
+ /* Basic */ {
+  C::StrRef str("GET /index.html HTTP/1.1\r\n");
+  $raw_assert(str.find(' ') == 3);
+  $raw_assert(str.find(' ', 4) == 15);
+  $raw_assert(str.rfind('/') == 20);
+  $raw_assert(str.rfind('/', 19) == 4);
+  $raw_assert(str.find("HTTP") == 16);
+  $raw_assert(str.find("") == 0);
+  $raw_assert(str.find("", str.size()) == str.size());
+  $raw_assert(str.rfind("T") == 18);
+  $raw_assert(str.findFirstOf("\r\n") == 24);
+  $raw_assert(str.findFirstNotOf("ETG") == 3);
+  $raw_assert(str.count('T') == 3);
+  $raw_assert(str.count("T") == 3);
+  $raw_assert(str.contains("index") && !str.contains('#'));
+  $raw_assert(C::StrRef("aaaa").count("aa") == 2);
+ } /* Matches std::string */ {
+  std::string buf;
+  C::u64 seed = 0x9E3779B97F4A7C15ULL;
+  for(int I = 0; I < 4096; ++I) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    // Skewed alphabet, with some high bytes.
+    const C::u32 r = C::u32(seed >> 40);
+    buf.push_back((r % 16 == 0) ? char(0x80 | (r & 0x7F))
+      : char('a' + (r % 5)));
+  }
+  const char* needles[] { "a", "ab", "cab", "abcd", "eeee", 
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab" };
+  const C::CharSet set = C::CharSet("de") |= C::CharSet("\x80\xff");
+  for(C::usize n : { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 
+   100, 255, 256, 1000, 4096 }) {
+    const std::string sv(buf.data(), n);
+    const C::StrRef str(buf.data(), n);
+    for(C::usize pos : { C::usize(0), n / 3, n, n + 1 }) {
+      for(char c : { 'a', 'e', 'z', char(0x85) }) {
+        $raw_assert(str.find(c, pos) == sv.find(c, pos));
+        $raw_assert(str.rfind(c, pos) == sv.rfind(c, pos));
+      }
+      for(const char* needle : needles) {
+        $raw_assert(str.find(needle, pos) == sv.find(needle, pos));
+        $raw_assert(str.rfind(needle, pos) == sv.rfind(needle, pos));
+      }
+      $raw_assert(str.findFirstOf(set, pos) == 
+        sv.find_first_of("de\x80\xff", pos));
+      $raw_assert(str.findFirstNotOf("abc", pos) == 
+        sv.find_first_not_of("abc", pos));
+    }
+    for(char c : { 'a', 'c', char(0x85) }) {
+      $raw_assert(str.count(c) ==
+        C::usize(std::count(sv.begin(), sv.end(), c)));
+    }
+  }
+ }
+}
+
+void strref_split_tests() {
+ /* Consume */ {
+  C::StrRef str("GET /index.html HTTP/1.1\r\nHost: x\r\n");
+  $raw_assert(str.consumeFront("GET "));
+  $raw_assert(!str.consumeFront("POST "));
+  $raw_assert(str.consumeUntil(' ') == "/index.html");
+  $raw_assert(str.consumeLine() == "HTTP/1.1");
+  $raw_assert(str.consumeUntil(": ") == "Host");
+  $raw_assert(str.consumeBack("\r\n"));
+  $raw_assert(str == "x");
+  $raw_assert(str.consumeUntil(',') == "x" && str.isEmpty());
+  C::StrRef ws("  \t key = value");
+  $raw_assert(ws.consumeWhile(C::CharSet(" \t")) == "  \t ");
+  $raw_assert(ws.consumeUntilAny(C::CharSet(" =")) == "key");
+  $raw_assert(ws == "= value");
+ } /* Split */ {
+  C::SmallVec<C::StrRef, 8> pieces;
+  $raw_assert(C::StrRef("a,,b,").split(',').collect(pieces) == 4);
+  $raw_assert(pieces[0] == "a" && pieces[1].isEmpty());
+  $raw_assert(pieces[2] == "b" && pieces[3].isEmpty());
+  $raw_assert(C::StrRef("").split(',').count() == 1);
+  $raw_assert(C::StrRef("a::b::c").split("::").count() == 3);
+  C::usize n = 0;
+  const C::CharSet ws(" \t");
+  for(C::StrRef word : C::StrRef("one two\tthree").splitAny(ws)) {
+    $raw_assert(!word.isEmpty());
+    ++n;
+  }
+  $raw_assert(n == 3);
+ } /* Lines */ {
+  $raw_assert(C::StrRef("").lines().count() == 0);
+  $raw_assert(C::StrRef("\n").lines().count() == 1);
+  $raw_assert(C::StrRef("a\r\n\nb").lines().count() == 3);
+  C::SmallVec<C::StrRef, 4> lines;
+  (void) C::StrRef("x\r\ny\n").lines().collect(lines);
+  $raw_assert(lines.size() == 2);
+  $raw_assert(lines[0] == "x" && lines[1] == "y");
+ } /* Fill */ {
+  C::Array<C::StrRef, 3> fields;
+  const C::StrRef csv("2024-01-01,INFO,main,started, ok");
+  $raw_assert(csv.split(',').fill(fields) == 3);
+  $raw_assert(fields[0] == "2024-01-01" && fields[1] == "INFO");
+  $raw_assert(fields[2] == "main,started, ok");
+  $raw_assert(C::StrRef("a,b").split(',').fill(fields) == 2);
+  $raw_assert(fields[1] == "b");
+ }
+}
+
 void poly_tests() {
   C::Poly<MyBase, Meower, Woofer> poly { };
   (void)poly.asBase();
@@ -187,6 +303,876 @@ void arrayref_tests() {
  }
 }
 
+void allocator_tests() {
+  using Alloc = C::MimAllocator<C::u32>;
+  auto res = Alloc::allocate_at_least(5);
+  $raw_assert(res.ptr && res.count >= 5);
+  Alloc::deallocate(res.ptr, res.count);
+  using OAlloc = C::MimAllocator<C::u32, 64>;
+  auto ores = OAlloc::allocate_at_least(3);
+  $raw_assert(ores.count >= 3);
+  $raw_assert((C::usize(ores.ptr) % 64) == 0);
+  OAlloc::deallocate(ores.ptr, ores.count);
+  C::OveralignedVec<C::u32, 64> ovec {};
+  for(C::u32 I = 0; I < 100; ++I)
+    ovec.push_back(I);
+  $raw_assert((C::usize(ovec.data()) % 64) == 0);
+  ovec.shrink_to_fit();
+  $raw_assert(ovec.back() == 99);
+}
+
+void relocvec_tests() {
+  C::RelocVec<C::u64> vec {};
+  for(C::u64 I = 0; I < 1000; ++I)
+    vec.push_back(I);
+  $raw_assert(vec.size() == 1000);
+  $raw_assert(vec.capacity() >= 1000);
+  $raw_assert(vec[999] == 999);
+  // Aliasing an element while growing.
+  vec.resize(vec.capacity());
+  vec.push_back(vec[500]);
+  $raw_assert(vec.back() == 500);
+  
+  /* Non-trivial */ {
+    C::RelocVec<C::Str> strs { "a", "b" };
+    for(int I = 0; I < 100; ++I)
+      strs.emplace_back(40, 'x');
+    $raw_assert(strs.front() == "a");
+    $raw_assert(strs.back().size() == 40);
+    auto copy = strs;
+    strs.clear();
+    $raw_assert(strs.isEmpty() && copy.size() == 102);
+    // Aliasing a range while growing.
+    copy.resize(copy.capacity(), C::Str("b"));
+    copy.append(copy.data(), copy.data() + 2);
+    $raw_assert(copy[copy.size() - 2] == "a");
+  }
+
+  /* Zeroed */ {
+    C::RelocVec<C::u32> zvec(1 << 20, C::zeroed);
+    $raw_assert(zvec[0] == 0 && zvec.back() == 0);
+    zvec.back() = 5;
+    zvec.resize(10);
+    zvec.resize(zvec.capacity() + 10, C::zeroed);
+    $raw_assert(zvec[9] == 0 && zvec.back() == 0);
+    auto* p = C::MimAllocator<C::u64, 64>::allocate_zeroed(8);
+    $raw_assert((C::usize(p) % 64) == 0 && p[7] == 0);
+    C::MimAllocator<C::u64, 64>::deallocate(p, 8);
+  }
+
+  /* Overaligned */ {
+    C::RelocVec<C::u32, 64> avec(10);
+    avec.resize(200, 7U);
+    $raw_assert((C::usize(avec.data()) % 64) == 0);
+    $raw_assert(avec[0] == 0 && avec[199] == 7);
+  }
+}
+
+static C::usize smallvec_sum(C::ImmutArrayRef<C::u32> arr) {
+  C::usize sum = 0;
+  for(C::u32 v : arr) sum += v;
+  return sum;
+}
+
+static void smallvec_fill(C::SmallVecImpl<C::u32>& vec, C::u32 n) {
+  for(C::u32 I = 0; I < n; ++I) vec.push_back(I);
+}
+
+void smallvec_tests() {
+  C::SmallVec<C::u32, 8> vec {};
+  $raw_assert(vec.isSmall() && vec.capacity() == 8);
+  smallvec_fill(vec, 8);
+  // Never touches the heap below `N`.
+  $raw_assert(vec.isSmall());
+  $raw_assert(smallvec_sum(vec) == 28);
+  vec.push_back(8);
+  $raw_assert(!vec.isSmall() && vec[8] == 8);
+  /* Insert/Erase */ {
+    vec.insert(vec.begin(), 100);
+    $raw_assert(vec.front() == 100 && vec[1] == 0);
+    vec.erase(vec.begin(), vec.begin() + 2);
+    $raw_assert(vec.front() == 1 && vec.size() == 8);
+    vec.insert(vec.end(), vec.front());
+    $raw_assert(vec.back() == 1);
+  } /* Moves */ {
+    C::SmallVec<C::Str, 2> strs { "a", "b" };
+    C::SmallVec<C::Str, 2> moved(std::move(strs));
+    $raw_assert(moved.isSmall() && moved[1] == "b");
+    moved.emplace_back("A long string that is not stored inline.");
+    C::SmallVec<C::Str, 2> stolen(std::move(moved));
+    $raw_assert(!stolen.isSmall() && stolen.size() == 3);
+    // Moved-from vectors reuse their inline buffer.
+    $raw_assert(moved.isSmall() && moved.capacity() == 2);
+    moved.emplace_back("x");
+    moved.emplace_back("y");
+    $raw_assert(moved.isSmall() && moved[1] == "y");
+    // Aliasing a range while growing.
+    C::SmallVec<C::Str, 2> big { "a", "b", "c" };
+    big.resize(big.capacity(), C::Str("b"));
+    big.append(big.data(), big.data() + 2);
+    $raw_assert(big[big.size() - 2] == "a");
+    C::SmallVec<C::Str, 2> other { "c" };
+    other.swap(stolen);
+    $raw_assert(other.size() == 3 && stolen[0] == "c");
+  } /* ArrayRef */ {
+    C::SmallVec<C::u32, 4> small { 1, 2, 3 };
+    C::ArrayRef<C::u32> ref = C::make_arrayref(small);
+    $raw_assert(ref.data() == small.data() && ref.size() == 3);
+#ifdef __cpp_deduction_guides
+    C::ImmutArrayRef iref(small);
+    $raw_assert(iref.back() == 3);
+#endif
+  }
+}
+
+void hash_tests() {
+  using Hasher = C::Hash<C::StrRef>;
+#if CPPVER_LEAST(14)
+  static_assert(Hasher{}("abc") == C::hash_value(C::StrRef("abc")),
+    "Short strings must be hashable in constexpr.");
+  static_assert(Hasher{}("abc") != Hasher{1}("abc"),
+    "Seeds must change the hash.");
+  static_assert(C::Hash<C::u32>{}(1) != C::Hash<C::u32>{}(2),
+    "Invalid integer hash.");
+#endif
+  const char* text = "A string which is long enough to "
+    "take the bulk path through the hasher, at least 48 bytes.";
+  const C::Str str(text);
+  // Every string type hashes the same way.
+  $raw_assert(Hasher{}(text) == C::Hash<C::Str>{}(str));
+  $raw_assert(Hasher{}(text) == C::hash_value(
+    C::ImmutArrayRef<char>(str.data(), str.size())));
+  $raw_assert(Hasher{}(text) != Hasher{}(C::StrRef(text).dropBack()));
+  /* Arrays */ {
+    C::Vec<C::u32> vec { 1, 2, 3 };
+    const C::usize h = C::hash_value(C::ArrayRef<C::u32>(vec));
+    vec.back() = 4;
+    $raw_assert(h != C::hash_value(C::ArrayRef<C::u32>(vec)));
+  } /* Composite */ {
+    C::Option<C::u32> none {};
+    C::Option<C::u32> some { 0U };
+    $raw_assert(C::hash_value(none) != C::hash_value(some));
+    auto tup = C::make_tuple(C::u32(1), C::StrRef("x"));
+    auto tup2 = C::make_tuple(C::u32(1), C::StrRef("y"));
+    $raw_assert(C::hash_value(tup) != C::hash_value(tup2));
+  }
+}
+
+void flatmap_tests() {
+  /* Insert/Find */ {
+    C::FlatMap<C::u32, C::u32> map {};
+    $raw_assert(map.isEmpty() && !map.contains(0));
+    for(C::u32 I = 0; I < 1000; ++I)
+      $raw_assert(map.tryEmplace(I, I * 2).second);
+    $raw_assert(!map.tryEmplace(7U, 0U).second);
+    $raw_assert(map.size() == 1000);
+    for(C::u32 I = 0; I < 1000; ++I)
+      $raw_assert(map.find(I)->second == I * 2);
+    $raw_assert(map.find(1000) == map.end());
+    C::usize count = 0;
+    for(auto& kv : map)
+      count += (kv.second == kv.first * 2);
+    $raw_assert(count == 1000);
+    map[5] = 1;
+    $raw_assert(map[5] == 1 && map[2000] == 0);
+    $raw_assert(!map.insertOrAssign(5U, 2U).second);
+    $raw_assert(map[5] == 2);
+  } /* Erase */ {
+    C::FlatMap<C::u32, C::u32> map { {1, 1}, {2, 2}, {3, 3} };
+    $raw_assert(map.erase(2) == 1 && map.erase(2) == 0);
+    $raw_assert(map.erase(map.find(1)) != map.find(1));
+    $raw_assert(map.size() == 1 && map.contains(3));
+    $raw_assert(map.tryEmplace(2U, 4U).second);
+    $raw_assert(map[2] == 4);
+    auto copy = map;
+    map.clear();
+    $raw_assert(map.isEmpty() && map.capacity() > 0);
+    $raw_assert(copy.size() == 2 && copy[3] == 3);
+  } /* Strings */ {
+    C::FlatMap<C::Str, int> map {};
+    map["alpha"] = 1;
+    map.tryEmplace(C::Str("beta"), 2);
+    const C::StrRef key = "alpha";
+    $raw_assert(map.find(key)->second == 1);
+    $raw_assert(map.contains(C::StrRef("beta")));
+    $raw_assert(!map.contains(C::StrRef("gamma")));
+    $raw_assert(map.erase(key) == 1 && map.size() == 1);
+    C::FlatSet<C::Str> set { "x", "y" };
+    $raw_assert(set.contains(C::StrRef("x")));
+    $raw_assert(!set.insert(C::StrRef("y")).second);
+  } /* Transparent */ {
+    // `StrRef` only converts to `Str`, so these can't
+    // compile unless the lookup is heterogeneous.
+    using TagStr = C::BasicStr<char, 
+      C::TaggedMimAllocator<char, C::AllocTag(4)>>;
+    C::FlatMap<TagStr, int> map {};
+    map[TagStr("a long enough key to allocate")] = 1;
+    const auto before = C::alloc_tag_stats(C::AllocTag(4));
+    const C::StrRef key = "a long enough key to allocate";
+    $raw_assert(map.find(key)->second == 1);
+    $raw_assert(map.contains(key) && !map.contains("missing"));
+# if CPPVER_LEAST(17)
+    const std::string_view view(key.data(), key.size());
+    $raw_assert(map.contains(view) && !map.contains(view.substr(1)));
+# endif
+    $raw_assert(map.erase(key) == 1 && map.isEmpty());
+    const auto after = C::alloc_tag_stats(C::AllocTag(4));
+    $raw_assert(after.allocCount == before.allocCount);
+    C::FlatMap<C::Str, int> strs { {"a", 1}, {"b", 2} };
+    // Iterators must not be taken as keys.
+    (void) strs.erase(strs.find(C::StrRef("a")));
+    $raw_assert(strs.size() == 1 && strs.contains("b"));
+  } /* Reserve/Rehash */ {
+    C::FlatSet<C::u64> set {};
+    set.reserve(100);
+    const C::usize cap = set.capacity();
+    $raw_assert(cap >= 100);
+    for(C::u64 I = 0; I < 100; ++I)
+      set.insert(I);
+    $raw_assert(set.capacity() == cap);
+    set.rehash(1000);
+    $raw_assert(set.capacity() > cap && set.size() == 100);
+    for(C::u64 I = 10; I < 100; ++I)
+      set.erase(I);
+    set.rehash(0);
+    $raw_assert(set.capacity() == 16 && set.size() == 10);
+    $raw_assert(set.contains(9) && !set.contains(10));
+  } /* Churn */ {
+    // Tombstones must not force the table to grow.
+    C::FlatSet<C::u64> set {};
+    for(C::u64 I = 0; I < 64; ++I)
+      set.insert(I);
+    const C::usize cap = set.capacity();
+    for(C::u64 I = 64; I < 100000; ++I) {
+      set.insert(I);
+      $raw_assert(set.erase(I - 64) == 1);
+    }
+    $raw_assert(set.size() == 64 && set.capacity() == cap);
+    for(C::u64 I = 100000 - 64; I < 100000; ++I)
+      $raw_assert(set.contains(I));
+  }
+}
+
+void interner_tests() {
+  /* Single */ {
+    C::StrInterner strs {};
+    $raw_assert(strs.size() == 1 && strs[C::Symbol()].isEmpty());
+    $raw_assert(strs.intern("") == C::Symbol());
+    const C::Symbol a = strs.intern("alpha");
+    const C::Symbol b = strs.intern(C::Str("beta"));
+    $raw_assert(a != b && strs.intern("alpha") == a);
+    $raw_assert(strs[a].isEqual("alpha") && strs[b].isEqual("beta"));
+    $raw_assert(strs[a].data()[5] == '\0');
+    $raw_assert(strs.find("beta").hasValue());
+    $raw_assert(*strs.find("beta") == b);
+    $raw_assert(!strs.find("gamma").hasValue());
+    // Spans several buckets of the symbol table.
+    C::Vec<C::Symbol> syms {};
+    for(int I = 0; I < 5000; ++I) {
+      const std::string num = std::to_string(I);
+      syms.push_back(strs.intern(C::StrRef(num.data(), num.size())));
+    }
+    for(int I = 0; I < 5000; ++I) {
+      const std::string num = std::to_string(I);
+      const C::StrRef str(num.data(), num.size());
+      $raw_assert(strs[syms[I]].isEqual(str));
+      $raw_assert(strs.intern(str) == syms[I]);
+    }
+    $raw_assert(strs.size() == 5003);
+  } /* Sync */ {
+    C::SyncStrInterner strs {};
+    constexpr int count = 2000;
+    C::Vec<C::Symbol> syms[4] {};
+    C::Vec<std::thread> threads {};
+    for(auto& out : syms) {
+      threads.emplace_back([&strs, &out] {
+        for(int I = 0; I < count; ++I) {
+          const std::string num = std::to_string(I);
+          out.push_back(strs.intern(
+            C::StrRef(num.data(), num.size())));
+        }
+      });
+    }
+    for(auto& thread : threads)
+      thread.join();
+    $raw_assert(strs.size() == count + 1);
+    for(int I = 0; I < count; ++I) {
+      for(auto& out : syms)
+        $raw_assert(out[I] == syms[0][I]);
+      const std::string num = std::to_string(I);
+      $raw_assert(strs[syms[0][I]].isEqual(
+        C::StrRef(num.data(), num.size())));
+    }
+    $raw_assert(strs.contains("0") && !strs.contains("x"));
+  }
+}
+
+void ringbuf_tests() {
+  /* Push/Pop */ {
+    C::RingBuf<int> ring {};
+    $raw_assert(ring.isEmpty() && ring.capacity() == 0);
+    for(int I = 0; I < 6; ++I)
+      ring.push_back(I);
+    ring.push_front(-1);
+    $raw_assert(ring.size() == 7 && ring.capacity() == 8);
+    $raw_assert(ring.front() == -1 && ring.back() == 5);
+    ring.pop_front();
+    ring.pop_back();
+    int expected = 0;
+    for(int i : ring)
+      $raw_assert(i == expected++);
+    $raw_assert(expected == 5);
+  } /* Bulk */ {
+    C::RingBuf<C::u32> ring(8);
+    const C::u32 in[] { 0, 1, 2, 3, 4, 5 };
+    ring.pushBack(in);
+    C::u32 out[4] {};
+    $raw_assert(ring.popFront(out) == 4 && out[3] == 3);
+    // Wraps around the end of the buffer.
+    ring.pushBack(in);
+    $raw_assert(ring.capacity() == 8 && ring.size() == 8);
+    auto slices = ring.twoSlices();
+    $raw_assert(slices.first.size() == 4 && slices.first[0] == 4);
+    $raw_assert(slices.second.size() == 4 && slices.second[0] == 2);
+    $raw_assert(slices.size() == ring.size());
+    ring.dropFront(3);
+    $raw_assert(ring.front() == 1 && ring.size() == 5);
+    // Growing unwraps the elements.
+    ring.pushBack(in);
+    $raw_assert(ring.capacity() == 16);
+    $raw_assert(ring.twoSlices().second.size() == 0);
+    $raw_assert(ring[0] == 1 && ring[10] == 5);
+  } /* Non-trivial */ {
+    C::RingBuf<std::string> ring { "a", "b" };
+    for(int I = 0; I < 20; ++I) {
+      ring.emplace_back(std::to_string(I));
+      ring.pop_front();
+    }
+    $raw_assert(ring.size() == 2 && ring.front() == "18");
+    auto copy = ring;
+    std::string out[3] {};
+    $raw_assert(copy.popFront(out) == 2);
+    $raw_assert(out[1] == "19" && copy.isEmpty());
+    $raw_assert(ring.back() == "19");
+  } /* Self-aliasing */ {
+    const std::string str(40, 'x');
+    C::RingBuf<std::string> ring(8);
+    for(int I = 0; I < 8; ++I)
+      ring.push_back(str + std::to_string(I));
+    // Growing must not invalidate the argument.
+    ring.push_front(ring.back());
+    $raw_assert(ring.capacity() == 16 && ring.front() == str + "7");
+    while(!ring.isFull())
+      ring.push_back(str);
+    ring.push_back(ring.front());
+    $raw_assert(ring.size() == 17 && ring.capacity() == 32);
+    $raw_assert(ring[1] == str + "0" && ring[8] == str + "7");
+    $raw_assert(ring.back() == str + "7");
+  }
+}
+
+void spsc_tests() {
+  /* Single Thread */ {
+    C::SpscQueue<int> queue(3);
+    $raw_assert(queue.capacity() == 4 && queue.isEmptyApprox());
+    for(int I = 0; I < 4; ++I)
+      $raw_assert(queue.tryPush(I));
+    $raw_assert(!queue.tryPush(4));
+    int out = -1;
+    $raw_assert(queue.tryPop(out) && out == 0);
+    $raw_assert(*queue.front() == 1);
+    const int in[] { 4, 5, 6 };
+    $raw_assert(queue.tryPushBatch(in) == 1);
+    int outs[8] {};
+    $raw_assert(queue.tryPopBatch(outs) == 4);
+    $raw_assert(outs[0] == 1 && outs[3] == 4);
+    $raw_assert(!queue.tryPop(out) && !queue.front());
+  } /* Non-trivial */ {
+    C::SpscQueue<std::string> queue(4);
+    $raw_assert(queue.tryEmplace(3, 'x'));
+    $raw_assert(queue.tryPush("left behind"));
+    std::string out;
+    $raw_assert(queue.tryPop(out) && out == "xxx");
+  } /* Threads */ {
+    constexpr C::u64 count = 200000;
+    C::SpscQueue<C::u64> queue(64);
+    std::thread producer([&queue] {
+      C::u64 batch[7] {};
+      C::u64 next = 0;
+      while(next < count) {
+        C::usize n = 0;
+        for(; n < 7 && next + n < count; ++n)
+          batch[n] = next + n;
+        next += queue.tryPushBatch(C::ImmutArrayRef<C::u64>(batch, n));
+      }
+    });
+    C::u64 expected = 0;
+    C::u64 outs[5] {};
+    while(expected < count) {
+      const C::usize n = queue.tryPopBatch(outs);
+      for(C::usize I = 0; I < n; ++I)
+        $raw_assert(outs[I] == expected++);
+    }
+    producer.join();
+    $raw_assert(queue.isEmptyApprox());
+  }
+}
+
+void mpmc_tests() {
+  /* Single Thread */ {
+    C::MpmcQueue<int> queue(4);
+    for(int I = 0; I < 4; ++I)
+      $raw_assert(queue.tryPush(I));
+    $raw_assert(!queue.tryPush(4) && queue.sizeApprox() == 4);
+    int outs[3] {};
+    $raw_assert(queue.tryPopBatch(outs) == 3 && outs[2] == 2);
+    const int in[] { 4, 5, 6, 7 };
+    $raw_assert(queue.tryPushBatch(in) == 3);
+    int out = -1;
+    queue.pop(out);
+    $raw_assert(out == 3);
+    $raw_assert(queue.tryPopBatch(outs) == 3 && outs[0] == 4);
+    $raw_assert(!queue.tryPop(out) && queue.isEmptyApprox());
+  } /* Non-trivial */ {
+    C::MpmcQueue<std::string> queue(2);
+    queue.push(std::string("left behind"));
+  } /* Threads */ {
+    // Small capacity, so both sides block often.
+    constexpr C::u64 per_thread = 20000;
+    constexpr C::u64 producers = 3;
+    C::MpmcQueue<C::u64> queue(8);
+    std::atomic<C::u64> sum { 0 };
+    C::Vec<std::thread> threads {};
+    for(C::u64 P = 0; P < producers; ++P) {
+      threads.emplace_back([&queue] {
+        for(C::u64 I = 1; I <= per_thread; ++I) {
+          if(I % 4 == 0) {
+            const C::u64 batch[] { I, I };
+            C::usize done = 0;
+            while(done < 2) {
+              done += queue.tryPushBatch(
+                C::ImmutArrayRef<C::u64>(batch + done, 2 - done));
+            }
+            continue;
+          }
+          queue.push(I);
+        }
+      });
+    }
+    for(int Cn = 0; Cn < 2; ++Cn) {
+      threads.emplace_back([&queue, &sum] {
+        C::u64 local = 0, out = 0;
+        // Both consumers stop on a zero.
+        while(true) {
+          queue.pop(out);
+          if(out == 0) break;
+          local += out;
+        }
+        sum += local;
+      });
+    }
+    for(C::u64 P = 0; P < producers; ++P)
+      threads[P].join();
+    queue.push(C::u64(0));
+    queue.push(C::u64(0));
+    for(C::usize I = producers; I < threads.size(); ++I)
+      threads[I].join();
+    // Multiples of 4 are pushed twice.
+    const C::u64 once = per_thread * (per_thread + 1) / 2;
+    const C::u64 fours = 4 * (per_thread / 4) * (per_thread / 4 + 1) / 2;
+    $raw_assert(sum == producers * (once + fours));
+  }
+}
+
+enum class TestOp : C::u8 {
+  Nop, Load, Store, Jump, Halt,
+  MEflEnumEnd(Halt)
+};
+
+enum class WideEnum : C::u16 {
+  Low = 0, Mid = 70, High = 129,
+  MEflEnumEnd(High)
+};
+
+void enum_array_tests() {
+ /* EnumArray */ {
+  MEflESAssert(C::EnumArray<TestOp, int>::Size() == 5);
+  static constexpr C::EnumArray<TestOp, int> cxpr {{{ 0, 1, 2, 3, 4 }}};
+  MEflESAssert(cxpr[TestOp::Store] == 2);
+  C::EnumArray<TestOp, C::Str> names {};
+  names[TestOp::Nop] = "nop";
+  names[TestOp::Halt] = "halt";
+  $raw_assert(names[TestOp::Halt] == "halt");
+  $raw_assert(names[TestOp::Load].empty());
+  C::usize seen = 0;
+  names.forEach([&](TestOp op, const C::Str& name) {
+    if(!name.empty() && names[op] == name)
+      ++seen;
+  });
+  $raw_assert(seen == 2);
+  auto copy = names;
+  $raw_assert(copy == names);
+  copy.fill("x");
+  $raw_assert(copy != names);
+ } /* EnumSet */ {
+  C::EnumSet<TestOp> set { TestOp::Load, TestOp::Jump };
+  $raw_assert(set.contains(TestOp::Jump));
+  $raw_assert(!set.contains(TestOp::Halt));
+  $raw_assert(set.count() == 2);
+  set.insert(TestOp::Halt).erase(TestOp::Load);
+  C::Vec<TestOp> members(set.begin(), set.end());
+  $raw_assert(members.size() == 2);
+  $raw_assert(members[0] == TestOp::Jump);
+  $raw_assert(members[1] == TestOp::Halt);
+  auto all = C::EnumSet<TestOp>::All();
+  $raw_assert(all.count() == 5);
+  $raw_assert((all - set).count() == 3);
+  $raw_assert((all & set) == set);
+  $raw_assert((all ^ all).isEmpty());
+ } /* Multiple words */ {
+  C::EnumSet<WideEnum> set {};
+  $raw_assert(set.isEmpty());
+  $raw_assert(set.begin() == set.end());
+  set.insert(WideEnum::High).insert(WideEnum::Mid);
+  C::u32 sum = 0;
+  set.forEach([&](WideEnum e) { sum += C::u32(e); });
+  $raw_assert(sum == 199);
+  auto it = set.begin();
+  $raw_assert(*it == WideEnum::Mid);
+  $raw_assert(*++it == WideEnum::High);
+  $raw_assert(++it == set.end());
+  $raw_assert(C::EnumSet<WideEnum>::All().count() == 130);
+#if CPPVER_LEAST(14)
+  constexpr C::EnumSet<WideEnum> cxpr { WideEnum::Low };
+  MEflESAssert(cxpr.count() == 1);
+#endif
+ }
+}
+
+enum class TestPerm : C::u32 {
+  Read = 1, Write = 2, Exec = 4, Admin = 8,
+  MEflFlagEnd(Admin)
+};
+
+void flagset_tests() {
+  using Perms = C::FlagSet<TestPerm>;
+ /* Constexpr */ {
+  MEflESAssert(Perms::Mask() == 0xF);
+  MEflESAssert(Perms::All().count() == 4);
+  MEflESAssert(Perms::IsValid(0x5));
+  MEflESAssert(!Perms::IsValid(0x10));
+  MEflESAssert(Perms::FromBitsTruncate(0x13).bits() == 0x3);
+#if CPPVER_LEAST(14)
+  constexpr Perms rw { TestPerm::Read, TestPerm::Write };
+  MEflESAssert(rw.has(TestPerm::Write));
+  MEflESAssert((~rw).bits() == 0xC);
+  MEflESAssert((rw - TestPerm::Read) == TestPerm::Write);
+#endif
+ } /* Algebra */ {
+  Perms rw { TestPerm::Read, TestPerm::Write };
+  Perms rx { TestPerm::Read, TestPerm::Exec };
+  $raw_assert((rw | rx).count() == 3);
+  $raw_assert((rw & rx) == TestPerm::Read);
+  $raw_assert((rw ^ rx) == (Perms::All() - TestPerm::Read - TestPerm::Admin));
+  $raw_assert(rw.has(rw & rx));
+  $raw_assert(!rw.has(rx));
+  $raw_assert(rw.hasAny(rx));
+  $raw_assert(!rw.hasAny(TestPerm::Admin));
+  $raw_assert((~Perms::All()).isEmpty());
+ } /* Modifiers */ {
+  Perms p {};
+  $raw_assert(!p);
+  p.set(TestPerm::Exec).set(TestPerm::Admin);
+  p.unset(TestPerm::Exec).toggle(TestPerm::Read);
+  $raw_assert(p.bits() == 0x9);
+  p.setTo(TestPerm::Write, true).setTo(TestPerm::Admin, false);
+  $raw_assert(p.bits() == 0x3);
+  C::u32 seen = 0, calls = 0;
+  Perms::All().forEachSet([&](TestPerm f) {
+    seen |= C::u32(f);
+    ++calls;
+  });
+  $raw_assert(seen == 0xF && calls == 4);
+ }
+}
+
+void handle_tests() {
+ /* Basic */ {
+  C::HandlePool<int> pool;
+  C::Handle<int> null {};
+  $raw_assert(null.isNull());
+  $raw_assert(!pool.contains(null));
+  auto a = pool.insert(1);
+  auto b = pool.insert(2);
+  auto c = pool.emplace(3);
+  $raw_assert(pool.size() == 3);
+  $raw_assert(pool[b] == 2 && *pool.get(c) == 3);
+  $raw_assert(pool.erase(a));
+  $raw_assert(!pool.erase(a));
+  $raw_assert(pool.get(a) == nullptr);
+  $raw_assert(pool[b] == 2 && pool[c] == 3);
+  // Reuses the slot, but with a new generation.
+  auto d = pool.insert(4);
+  $raw_assert(d.index() == a.index());
+  $raw_assert(d != a && !pool.contains(a));
+  $raw_assert(pool.slotCount() == 3);
+ } /* Dense iteration */ {
+  C::HandlePool<std::string> pool;
+  C::Vec<C::Handle<std::string>> hs;
+  for(int I = 0; I < 64; ++I)
+    hs.push_back(pool.insert(std::to_string(I)));
+  for(int I = 0; I < 64; I += 2)
+    $raw_assert(pool.erase(hs[I]));
+  $raw_assert(pool.size() == 32);
+  C::usize count = 0;
+  for(const std::string& s : pool)
+    count += (std::stoi(s) % 2 == 1);
+  $raw_assert(count == 32);
+  pool.forEach([&](C::Handle<std::string> h, std::string& s) {
+    $raw_assert(pool.contains(h) && &pool[h] == &s);
+  });
+  for(int I = 1; I < 64; I += 2)
+    $raw_assert(pool[hs[I]] == std::to_string(I));
+  pool.clear();
+  $raw_assert(pool.isEmpty());
+  $raw_assert(!pool.contains(hs[1]));
+  auto h = pool.insert("x");
+  $raw_assert(pool[h] == "x" && pool.slotCount() == 64);
+ } /* Hash */ {
+  C::FlatSet<C::Handle<int>> set;
+  set.insert(C::Handle<int>(1, 1));
+  set.insert(C::Handle<int>(1, 2));
+  $raw_assert(set.size() == 2);
+  $raw_assert(set.contains(C::Handle<int>(1, 2)));
+ }
+}
+
+void stats_tests() {
+  constexpr auto tag = C::AllocTag(3);
+  using Alloc = C::TaggedMimAllocator<C::u64, tag>;
+  const auto before = C::alloc_tag_stats(tag);
+  /* Vec */ {
+    C::Vec<C::u64, Alloc> vec {};
+    vec.reserve(100);
+    auto stats = C::alloc_tag_stats(tag);
+    $raw_assert(stats.allocCount == before.allocCount + 1);
+    $raw_assert(stats.liveBytes() - before.liveBytes() == 800);
+  }
+  const auto after = C::alloc_tag_stats(tag);
+  $raw_assert(after.liveBytes() == before.liveBytes());
+  $raw_assert(after.freeCount == before.freeCount + 1);
+  const auto snapshot = C::snapshot_alloc_stats();
+  $raw_assert(snapshot.tags[3].allocCount == after.allocCount);
+  $raw_assert(snapshot.mimalloc.committed.current > 0);
+  $raw_assert(snapshot.mimalloc.committed.peak >= 
+    snapshot.mimalloc.committed.current);
+  /* Zeroed/Deferred */ {
+    C::u64* p = Alloc::allocate_zeroed(16);
+    $raw_assert(p[15] == 0);
+    const auto mid = C::alloc_tag_stats(tag);
+    $raw_assert(mid.liveBytes() - after.liveBytes() == 128);
+    Alloc::deallocate_deferred(p, 16);
+    (void) C::collect_deferred_frees();
+    const auto end = C::alloc_tag_stats(tag);
+    $raw_assert(end.liveBytes() == after.liveBytes());
+  }
+  $raw_assert(snapshot.process.currentRss > 0);
+}
+
+void config_tests() {
+  // Set by `MEflMimConfig(TestMimConfig)`.
+  $raw_assert(C::MimConfig::Current().getPurgeDelay() == 25);
+  const bool applied = C::MimConfig()
+    .purgeDelay(10)
+    .arenaReserve(256 * 1024 * 1024)
+    .apply();
+  $raw_assert(applied);
+  const auto config = C::MimConfig::Current();
+  $raw_assert(config.getPurgeDelay() == 10);
+  $raw_assert(config.getArenaReserve() == 256 * 1024 * 1024);
+}
+
+void heap_tests() {
+  C::MimHeap heap {};
+  $raw_assert(!heap.isEmpty());
+ /* Containers */ {
+  C::Vec<C::u64, C::MimHeapAllocator<C::u64>> 
+    vec(heap.allocator<C::u64>());
+  vec.assign({ 1, 2, 3, 4 });
+  $raw_assert(heap.contains(vec.data()));
+  C::BasicStr<char, C::MimHeapAllocator<char>> 
+    str("Hello heap! Long enough to allocate.", heap);
+  $raw_assert(heap.contains(str.data()));
+ } /* Box */ {
+  auto box = C::Box<C::i32>::NewIn(heap.allocator<C::i32>(), 7);
+  $raw_assert(heap.contains(box.get()) && *box == 7);
+ }
+  heap.destroy();
+  $raw_assert(heap.isEmpty());
+}
+
+void pool_tests() {
+  struct Node {
+    Node(C::u32 v) : value(v) { }
+    C::u32 value;
+    Node* next = nullptr;
+  };
+  using Pool = C::PoolBoxAllocator<Node>;
+  static_assert(Pool::blockSize == 16, "Invalid pool block size.");
+  C::Vec<C::PoolBox<Node>> boxes {};
+  for(C::u32 I = 0; I < 2048; ++I)
+    boxes.push_back(C::PoolBox<Node>::New(I));
+  for(C::u32 I = 0; I < 2048; ++I) {
+    $raw_assert(boxes[I]->value == I);
+    $raw_assert((C::usize(boxes[I].get()) % Pool::blockSize) == 0);
+  }
+  Node* last = boxes.back().get();
+  boxes.pop_back();
+  auto reused = C::PoolBox<Node>::New(7U);
+  // Freed blocks are reused first.
+  $raw_assert(reused.get() == last);
+  boxes.clear();
+  
+  /* Overaligned */ {
+    struct alignas(128) Big { C::u32 data[40]; };
+    using BigPool = C::PoolBoxAllocator<Big>;
+    static_assert(BigPool::blockSize == 256, "Invalid pool block size.");
+    Big* a = BigPool::New();
+    Big* b = BigPool::New();
+    $raw_assert((C::usize(a) % 128) == 0);
+    $raw_assert((C::usize(b) % 128) == 0);
+    BigPool::Delete(a);
+    BigPool::Delete(b);
+  }
+
+  /* Batches */ {
+    C::H::PoolShared shared { 16, 16 };
+    const C::usize max = C::usize(shared.cacheMax);
+    C::Vec<void*> blocks {};
+    /* Producer */ {
+      C::H::PoolCache cache { shared };
+      for(C::usize I = 0; I <= max; ++I)
+        blocks.push_back(cache.allocate());
+      for(void* p : blocks)
+        cache.deallocate(p);
+    }
+    C::H::PoolCache cache { shared };
+    // Takes the slab remainder, then one block of the full batch.
+    blocks.clear();
+    for(C::usize I = 0; I < max / 2; ++I)
+      blocks.push_back(cache.allocate());
+    $raw_assert(shared.batches_ == nullptr);
+    void* p = blocks.back();
+    blocks.pop_back();
+    // Taken batches count towards the next flush.
+    cache.deallocate(p);
+    C::usize count = 0;
+    $raw_assert(shared.batches_ != nullptr);
+    for(auto* B = shared.batches_; B; B = B->next)
+      ++count;
+    $raw_assert(count == max + 1);
+  }
+}
+
+void scope_tests() {
+  C::MimHeap heap {};
+  C::MimHeap inner {};
+  $raw_assert(C::AllocScope::Current() == nullptr);
+  C::Vec<C::u64> vec {};
+  C::Vec<C::u64> outer {};
+  /* Scoped */ {
+    C::AllocScope scope(heap);
+    vec.resize(100);
+    /* Nested */ {
+      C::AllocScope nested(inner);
+      $raw_assert(C::AllocScope::Current() == inner.get());
+      C::Vec<C::u32, C::MimAllocator<C::u32, 64>> avec(10);
+      $raw_assert(inner.contains(avec.data()));
+    }
+    $raw_assert(C::AllocScope::Current() == heap.get());
+  }
+  outer.resize(100);
+  $raw_assert(C::AllocScope::Current() == nullptr);
+  $raw_assert(heap.contains(vec.data()));
+  $raw_assert(!heap.contains(outer.data()));
+  // Blocks outlive the scope.
+  vec.clear();
+  vec.shrink_to_fit();
+}
+
+void numa_tests() {
+  const C::usize nodes = C::numa_node_count();
+  $raw_assert(nodes >= 1);
+  $raw_assert(C::usize(C::current_numa_node()) < nodes);
+  C::NumaHeap heap {};
+  // Single node systems use the default heap.
+  $raw_assert(heap.isBound() == (nodes > 1));
+  /* Vec */ {
+    C::Vec<C::u64, C::MimHeapAllocator<C::u64>> 
+      vec(heap.allocator<C::u64>());
+    vec.resize(1000, 3);
+    $raw_assert(vec.back() == 3);
+  }
+  C::Vec<C::u32, C::NumaAllocator<C::u32>> vec(100, 1U);
+  $raw_assert(vec[99] == 1);
+}
+
+void arena_tests() {
+  C::Arena arena {};
+  $raw_assert(arena.isEmpty());
+  auto mark = arena.mark();
+ /* Containers */ {
+  C::Vec<C::u32, C::ArenaAllocator<C::u32>> vec(arena);
+  for(C::u32 i = 0; i < 64; ++i) vec.push_back(i);
+  $raw_assert(vec[63] == 63);
+  C::BasicStr<char, C::ArenaAllocator<char>> 
+    str("Hello arena! Long enough to allocate.", arena);
+  $raw_assert(str.back() == '.');
+ } /* Box */ {
+  auto box = C::Box<C::i32>::NewIn(
+    C::ArenaAllocator<C::i32>(arena), 7);
+  $raw_assert(*box == 7);
+ }
+  $raw_assert(!arena.isEmpty());
+  arena.rollback(mark);
+  $raw_assert(arena.isEmpty());
+  (void) arena.allocate(32, 64);
+  arena.reset();
+  $raw_assert(arena.remaining() == 
+    arena.capacity() - sizeof(HH::ArenaChunk));
+ /* Padding */ {
+  // The padding is larger than what's left in the chunk.
+  C::Arena small(256);
+  (void) small.allocate(1, 1);
+  (void) small.allocate(small.remaining() - 1, 1);
+  $raw_assert(small.remaining() == 1);
+  auto* p = static_cast<C::ubyte*>(small.allocate(8, 4096));
+  $raw_assert(p && reinterpret_cast<std::uintptr_t>(p) % 4096 == 0);
+  $raw_assert(p + 8 == small.mark().cur_);
+  $raw_assert(small.remaining() < small.capacity());
+ }
+}
+
+void deferred_tests() {
+  using Alloc = C::MimAllocator<C::u64>;
+  constexpr C::usize count = 1000;
+  // Registers this thread as an owner.
+  $raw_assert(C::collect_deferred_frees() == 0);
+  C::Vec<C::u64*> ptrs {};
+  for(C::usize I = 0; I < count; ++I)
+    ptrs.push_back(Alloc::allocate(1));
+  std::thread remote([&ptrs] {
+    for(C::u64* P : ptrs)
+      Alloc::deallocate_deferred(P, 1);
+    C::flush_deferred_frees();
+  });
+  remote.join();
+  $raw_assert(C::collect_deferred_frees() == count);
+  // Local blocks are freed right away.
+  Alloc::deallocate_deferred(Alloc::allocate(1), 1);
+  $raw_assert(C::collect_deferred_frees() == 0);
+}
+
 int option_tests() {
   constexpr C::Option<C::i32> i32_op {1};
   C::i32 i = MEflUnwrap(i32_op) + 4;
@@ -29,23 +29,40 @@
 
 #include <CoreCommon/ConfigCache.hpp>
 #include "Core/AlignedStorage.hpp"
+#include "Core/AllocScope.hpp"
+#include "Core/AllocStats.hpp"
+#include "Core/Arena.hpp"
 #include "Core/Array.hpp"
 #include "Core/ArrayRef.hpp"
 #include "Core/Binding.hpp"
+#include "Core/Bits.hpp"
 #include "Core/Box.hpp"
 #include "Core/Casts.hpp"
 #include "Core/Endian.hpp"
 #include "Core/Enum.hpp"
+#include "Core/FlatMap.hpp"
 #include "Core/Fundamental.hpp"
+#include "Core/Handle.hpp"
+#include "Core/Hash.hpp"
 #include "Core/MimAllocator.hpp"
+#include "Core/MimConfig.hpp"
+#include "Core/MimHeapAllocator.hpp"
+#include "Core/MpmcQueue.hpp"
 #include "Core/Mtx.hpp"
+#include "Core/NumaHeap.hpp"
 #include "Core/Option.hpp"
 #include "Core/OverloadSet.hpp"
 #include "Core/Poly.hpp"
+#include "Core/PoolBoxAllocator.hpp"
 #include "Core/Preload.hpp"
 #include "Core/Ref.hpp"
+#include "Core/RelocVec.hpp"
 #include "Core/Result.hpp"
+#include "Core/RingBuf.hpp"
+#include "Core/SmallVec.hpp"
+#include "Core/SpscQueue.hpp"
 #include "Core/Str.hpp"
+#include "Core/StrInterner.hpp"
 #include "Core/StrRef.hpp"
 #include "Core/Traits.hpp"
 #include "Core/Tuple.hpp"
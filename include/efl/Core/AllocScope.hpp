@@ -0,0 +1,72 @@
+//===- Core/AllocScope.hpp ------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines a scope which redirects MimAllocator
+//  allocations on the current thread into a chosen heap.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_ALLOCSCOPE_HPP
+#define EFL_CORE_ALLOCSCOPE_HPP
+
+#include "MimHeapAllocator.hpp"
+#include "NumaHeap.hpp"
+
+namespace efl {
+namespace C {
+/**
+ * @brief Redirects `MimAllocator` allocations into a heap.
+ * 
+ * While in scope, every allocation made on the current thread 
+ * through `MimAllocatorBase` comes from the given heap. Scopes nest,
+ * and the previous heap is restored on destruction. Blocks may still
+ * be freed anywhere, and outlive the scope. The heap must belong
+ * to the current thread, and outlive the scope.
+ */
+struct AllocScope {
+  using HandleType = H::MimHeapHandle;
+public:
+  /// Redirects into `heap`, null uses the default heap.
+  explicit AllocScope(HandleType heap) NOEXCEPT;
+
+  explicit AllocScope(const MimHeap& heap) NOEXCEPT
+   : AllocScope(heap.get()) { }
+
+  /// Unbound heaps use the default heap.
+  explicit AllocScope(const NumaHeap& heap) NOEXCEPT
+   : AllocScope(heap.heap().get()) { }
+
+  AllocScope(const AllocScope&) = delete;
+  AllocScope& operator=(const AllocScope&) = delete;
+
+  /// Restores the previous heap.
+  ~AllocScope();
+
+  /// The heap of the innermost scope, or null.
+  NODISCARD static HandleType Current() NOEXCEPT;
+
+private:
+  HandleType prev_;
+};
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_ALLOCSCOPE_HPP
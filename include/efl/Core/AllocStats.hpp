@@ -0,0 +1,236 @@
+//===- Core/AllocStats.hpp ------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines per-tag allocation accounting, and snapshots
+//  which combine the counters with mimalloc's statistics.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_ALLOCSTATS_HPP
+#define EFL_CORE_ALLOCSTATS_HPP
+
+#include <atomic>
+#include <CoreCommon/Multithreaded.hpp>
+#include "MimAllocator.hpp"
+
+namespace efl {
+namespace C {
+/// Identifies the owner of an allocation.
+/// Cast your own values into this, eg. `AllocTag(MyTag::Parser)`.
+enum class AllocTag : u8 { Default = 0 };
+
+/// The number of distinct tags, values must be below this.
+GLOBAL H::SzType maxAllocTags = 64;
+
+/// Totals for a single tag.
+struct AllocTagStats {
+  /// Bytes which have not been freed yet.
+  i64 liveBytes() const NOEXCEPT {
+    return i64(allocBytes) - i64(freeBytes);
+  }
+
+  /// Allocations which have not been freed yet.
+  i64 liveCount() const NOEXCEPT {
+    return i64(allocCount) - i64(freeCount);
+  }
+
+public:
+  u64 allocBytes = 0;
+  u64 allocCount = 0;
+  u64 freeBytes = 0;
+  u64 freeCount = 0;
+};
+
+/// A statistic tracked by mimalloc.
+struct MimStatCount {
+  i64 current = 0;
+  i64 peak = 0;
+};
+
+/// Statistics from mimalloc, in bytes.
+struct MimStatsInfo {
+  MimStatCount committed;
+};
+
+/// Process information from `mi_process_info`.
+struct MimProcessInfo {
+  usize elapsedMs = 0;
+  usize userMs = 0;
+  usize systemMs = 0;
+  usize currentRss = 0;
+  usize peakRss = 0;
+  usize currentCommit = 0;
+  usize peakCommit = 0;
+  usize pageFaults = 0;
+};
+
+/// Aggregated counters for every tag, along with 
+/// mimalloc's own statistics at the time of the snapshot.
+struct AllocStatsSnapshot {
+  AllocTagStats tags[maxAllocTags];
+  MimStatsInfo mimalloc;
+  MimProcessInfo process;
+};
+
+namespace H {
+  /// Counters owned by a single thread.
+  /// Only the owner writes, so updates need not be atomic RMWs.
+  struct AllocCounter {
+    ALWAYS_INLINE static void 
+     Add(std::atomic<u64>& a, u64 v) NOEXCEPT {
+      a.store(a.load(std::memory_order_relaxed) + v, 
+        std::memory_order_relaxed);
+    }
+
+    ALWAYS_INLINE void onAllocate(SzType size) NOEXCEPT {
+      AllocCounter::Add(allocBytes, size);
+      AllocCounter::Add(allocCount, 1);
+    }
+
+    ALWAYS_INLINE void onDeallocate(SzType size) NOEXCEPT {
+      AllocCounter::Add(freeBytes, size);
+      AllocCounter::Add(freeCount, 1);
+    }
+
+  public:
+    std::atomic<u64> allocBytes { 0 };
+    std::atomic<u64> allocCount { 0 };
+    std::atomic<u64> freeBytes  { 0 };
+    std::atomic<u64> freeCount  { 0 };
+  };
+
+  /// Thread-local tag counters, registered for aggregation.
+  /// Totals are kept when a thread exits.
+  struct AllocTagCounters {
+    AllocTagCounters() NOEXCEPT;
+    AllocTagCounters(const AllocTagCounters&) = delete;
+    ~AllocTagCounters();
+
+    ALWAYS_INLINE AllocCounter& operator[](AllocTag tag) NOEXCEPT {
+      EFLI_DBGASSERT_(SzType(tag) < maxAllocTags);
+      return counters_[SzType(tag)];
+    }
+
+  public:
+    AllocCounter counters_[maxAllocTags];
+    AllocTagCounters* prev_ = nullptr;
+    AllocTagCounters* next_ = nullptr;
+  };
+
+  /// Gets the counters for the current thread.
+  inline AllocTagCounters& thread_alloc_counters() NOEXCEPT {
+    static EFL_THREADLOCAL AllocTagCounters counters { };
+    return counters;
+  }
+} // namespace H
+
+/// Sums the counters for `tag` over every thread.
+AllocTagStats alloc_tag_stats(AllocTag tag);
+
+/// Captures the counters for every tag, along with
+/// mimalloc's statistics and process information.
+AllocStatsSnapshot snapshot_alloc_stats();
+
+/**
+ * @brief `MimAllocator` which attributes memory to `Tag`.
+ * 
+ * Allocations and deallocations are counted per thread,
+ * see `alloc_tag_stats(...)` and `snapshot_alloc_stats()`.
+ * Memory may be freed on any thread, so the live totals
+ * are only meaningful once summed over every thread.
+ */
+template <typename T, AllocTag Tag,
+  H::SzType Align = alignof(T)>
+struct MSVC_EMPTY_BASES TaggedMimAllocator 
+ : MimAllocator<T, Align> {
+  using BaseType = MimAllocator<T, Align>;
+  using value_type = T;
+  using size_type = H::SzType;
+  static constexpr AllocTag tag = Tag;
+
+  template <typename U, H::SzType UAlign = 
+    ((alignof(U) > Align) ? alignof(U) : Align)>
+  struct rebind {
+    using other = TaggedMimAllocator<U, Tag, UAlign>;
+  };
+
+public:
+  constexpr TaggedMimAllocator() NOEXCEPT = default;
+  constexpr TaggedMimAllocator(const TaggedMimAllocator&) NOEXCEPT = default;
+  template <typename U, H::SzType UAlign>
+  constexpr TaggedMimAllocator(
+   const TaggedMimAllocator<U, Tag, UAlign>&) NOEXCEPT { }
+
+  //=== Member Functions ===//
+
+  NODISCARD static T* allocate(size_type n) {
+    T* p = BaseType::allocate(n);
+    if(EFL_LIKELY(p))
+      H::thread_alloc_counters()[Tag].onAllocate(sizeof(T) * n);
+    return p;
+  }
+
+  NODISCARD static T* allocate_zeroed(size_type n) {
+    T* p = BaseType::allocate_zeroed(n);
+    if(EFL_LIKELY(p))
+      H::thread_alloc_counters()[Tag].onAllocate(sizeof(T) * n);
+    return p;
+  }
+
+  NODISCARD static AllocationResult<T*, size_type> 
+   allocate_at_least(size_type n) {
+    auto res = BaseType::allocate_at_least(n);
+    if(EFL_LIKELY(res.ptr))
+      H::thread_alloc_counters()[Tag].onAllocate(sizeof(T) * res.count);
+    return res;
+  }
+
+  static void deallocate(T* ptr, size_type n) {
+    H::thread_alloc_counters()[Tag].onDeallocate(sizeof(T) * n);
+    return BaseType::deallocate(ptr, n);
+  }
+
+  /// Counted on the calling thread, like `deallocate`.
+  static void deallocate_deferred(T* ptr, size_type n) {
+    H::thread_alloc_counters()[Tag].onDeallocate(sizeof(T) * n);
+    return BaseType::deallocate_deferred(ptr, n);
+  }
+};
+
+template <typename T1, typename T2, AllocTag Tag,
+  H::SzType A1, H::SzType A2>
+HINT_INLINE constexpr bool operator==(
+ const TaggedMimAllocator<T1, Tag, A1>&, 
+ const TaggedMimAllocator<T2, Tag, A2>&)
+ NOEXCEPT { return true; }
+
+#if CPPVER_MOST(17)
+template <typename T1, typename T2, AllocTag Tag,
+  H::SzType A1, H::SzType A2>
+HINT_INLINE constexpr bool operator!=(
+ const TaggedMimAllocator<T1, Tag, A1>&, 
+ const TaggedMimAllocator<T2, Tag, A2>&)
+ NOEXCEPT { return false; }
+#endif // Three-way Comparison Check (C++20)
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_ALLOCSTATS_HPP
@@ -0,0 +1,260 @@
+//===- Core/Arena.hpp -----------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines a bump-pointer region allocator, which takes
+//  chunks from mimalloc. Memory is released all at once.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_ARENA_HPP
+#define EFL_CORE_ARENA_HPP
+
+#include "Fundamental.hpp"
+#include "Traits/Functions.hpp"
+#include "_Builtins.hpp"
+#include "_Version.hpp"
+
+namespace efl {
+namespace C {
+namespace H {
+  /// Header placed at the start of every arena chunk.
+  struct ArenaChunk {
+    ALWAYS_INLINE ubyte* begin() NOEXCEPT 
+    { return reinterpret_cast<ubyte*>(this + 1); }
+
+    ALWAYS_INLINE ubyte* end() NOEXCEPT 
+    { return reinterpret_cast<ubyte*>(this) + size; }
+  public:
+    ArenaChunk* prev;
+    SzType size;
+  };
+
+  ALWAYS_INLINE static ubyte* align_ptr(
+   ubyte* p, SzType align) NOEXCEPT {
+    const auto ip = reinterpret_cast<std::uintptr_t>(p);
+    const auto mask = std::uintptr_t(align - 1);
+    return p + (((ip + mask) & ~mask) - ip);
+  }
+} // namespace H
+
+/**
+ * @brief Bump-pointer region allocator.
+ * 
+ * Allocations are carved out of chunks taken from mimalloc.
+ * Individual objects are never freed (besides the most recent one),
+ * instead everything is released with `reset()` or `rollback(...)`.
+ * Destructors are NOT run, so only use this for types which
+ * are trivially destructible, or are manually destroyed.
+ */
+struct Arena {
+  using size_type = H::SzType;
+  static constexpr size_type defaultChunkSize = 16 * 1024;
+  static constexpr size_type maxChunkSize = 1024 * 1024;
+  static constexpr size_type defaultAlign = alignof(std::max_align_t);
+
+  /// Saved position in the arena, see `mark()`.
+  struct Marker {
+    constexpr Marker() NOEXCEPT = default;
+    constexpr Marker(H::ArenaChunk* chunk, ubyte* cur) NOEXCEPT
+     : chunk_(chunk), cur_(cur) { }
+  public:
+    H::ArenaChunk* chunk_ = nullptr;
+    ubyte* cur_ = nullptr;
+  };
+
+public:
+  /// Creates an empty arena, no memory is reserved up front.
+  explicit Arena(size_type chunk_size = defaultChunkSize) NOEXCEPT
+   : next_size_(chunk_size) { }
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /// Takes ownership of the chunks in `arena`.
+  Arena(Arena&& arena) NOEXCEPT
+   : chunk_(arena.chunk_), cur_(arena.cur_), 
+   end_(arena.end_), next_size_(arena.next_size_) {
+    arena.chunk_ = nullptr;
+    arena.cur_ = arena.end_ = nullptr;
+  }
+
+  /// Releases every chunk.
+  ~Arena() { Arena::FreeChunks(this->chunk_, nullptr); }
+
+  //=== Allocation ===//
+
+  /// Allocates `size` bytes aligned to `align`.
+  NODISCARD ALWAYS_INLINE void* 
+   allocate(size_type size, size_type align = defaultAlign) {
+    $raw_assert(H::is_power_of_2(align));
+    ubyte* p = H::align_ptr(this->cur_, align);
+    // The padding may be larger than what's left.
+    const size_type pad = size_type(p - this->cur_);
+    const size_type avail = this->remaining();
+    if(EFL_LIKELY(this->cur_ && 
+     pad <= avail && size <= avail - pad)) {
+      this->cur_ = p + size;
+      return p;
+    }
+    return this->allocateSlow(size, align);
+  }
+
+  /// Frees `p` if it was the most recent allocation.
+  /// Otherwise the memory is held until the arena is reset.
+  ALWAYS_INLINE void deallocate(void* p, size_type size) NOEXCEPT {
+    ubyte* const data = static_cast<ubyte*>(p);
+    if(EFL_SOFT_LIKELY(data && data + size == this->cur_))
+      this->cur_ = data;
+  }
+
+  /// Allocates and constructs a `T`.
+  /// The destructor is never invoked by the arena.
+  template <typename T, typename...Args>
+  NODISCARD T* New(Args&&...args) {
+    void* data = this->allocate(sizeof(T), alignof(T));
+    return X11::construct(static_cast<T*>(data), FWD_CAST(args)...);
+  }
+
+  //=== Markers ===//
+
+  /// Saves the current position of the arena.
+  NODISCARD Marker mark() const NOEXCEPT {
+    return { this->chunk_, this->cur_ };
+  }
+
+  /// Releases everything allocated after `marker` was taken.
+  /// The marker must not be older than the last `reset()`.
+  void rollback(Marker marker) NOEXCEPT;
+
+  /// Releases every allocation. The newest chunk is kept,
+  /// so the next cycle of allocations won't hit mimalloc.
+  void reset() NOEXCEPT;
+
+  //=== Observers ===//
+
+  /// Checks if no chunks have been allocated.
+  ALWAYS_INLINE bool isEmpty() const NOEXCEPT
+  { return !this->chunk_; }
+
+  /// The number of bytes left in the current chunk.
+  ALWAYS_INLINE size_type remaining() const NOEXCEPT
+  { return size_type(this->end_ - this->cur_); }
+
+  /// The total size of all chunks, including headers.
+  size_type capacity() const NOEXCEPT;
+
+private:
+  NODISCARD void* allocateSlow(size_type size, size_type align);
+  static void FreeChunks(H::ArenaChunk* from, H::ArenaChunk* to) NOEXCEPT;
+
+private:
+  H::ArenaChunk* chunk_ = nullptr;
+  ubyte* cur_ = nullptr;
+  ubyte* end_ = nullptr;
+  size_type next_size_ = defaultChunkSize;
+};
+
+/**
+ * @brief Allocator adapter for `Arena`.
+ * 
+ * Can be used with `Vec`, `BasicStr`, and with 
+ * `Box<T, ArenaAllocator<T>>` through `Box::NewIn(...)`.
+ */
+template <typename T>
+struct ArenaAllocator {
+  template <typename>
+  friend struct ArenaAllocator;
+public:
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = H::SzType;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_copy_assignment = H::TrueType;
+  using propagate_on_container_move_assignment = H::TrueType;
+  using propagate_on_container_swap = H::TrueType;
+  using is_always_equal = H::FalseType;
+
+public:
+  ArenaAllocator() = delete;
+  constexpr ArenaAllocator(const ArenaAllocator&) NOEXCEPT = default;
+
+  /// Binds the allocator to `arena`.
+  constexpr ArenaAllocator(Arena& arena) NOEXCEPT 
+   : arena_(X11::addressof(arena)) { }
+  
+  /// Rebinding constructor.
+  template <typename U>
+  constexpr ArenaAllocator(const ArenaAllocator<U>& alloc) NOEXCEPT
+   : arena_(alloc.arena_) { }
+
+  ArenaAllocator& operator=(const ArenaAllocator&) = default;
+
+  //=== Member Functions ===//
+
+  NODISCARD T* allocate(size_type n) const {
+    return static_cast<T*>(
+      arena_->allocate(sizeof(T) * n, alignof(T)));
+  }
+
+  void deallocate(T* ptr, size_type n) const NOEXCEPT {
+    arena_->deallocate(ptr, sizeof(T) * n);
+  }
+
+  /// Constructs an object in the bound arena.
+  /// Used by `Box<T, ArenaAllocator<T>>::NewIn(...)`.
+  template <typename...Args>
+  NODISCARD pointer New(Args&&...args) const {
+    return arena_->template New<T>(FWD_CAST(args)...);
+  }
+
+  /// Destroys an object. The storage is released with the arena.
+  static void Delete(pointer data) {
+    if(EFL_SOFT_UNLIKELY(!data)) return;
+    X11::destruct(data);
+  }
+
+  ALWAYS_INLINE Arena* arena() const NOEXCEPT
+  { return this->arena_; }
+
+private:
+  Arena* arena_;
+};
+
+template <typename T1, typename T2>
+HINT_INLINE constexpr bool operator==(
+ const ArenaAllocator<T1>& t1, 
+ const ArenaAllocator<T2>& t2) NOEXCEPT { 
+  return t1.arena() == t2.arena();
+}
+
+#if CPPVER_MOST(17)
+template <typename T1, typename T2>
+HINT_INLINE constexpr bool operator!=(
+ const ArenaAllocator<T1>& t1, 
+ const ArenaAllocator<T2>& t2) NOEXCEPT { 
+  return t1.arena() != t2.arena();
+}
+#endif // Three-way Comparison Check (C++20)
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_ARENA_HPP
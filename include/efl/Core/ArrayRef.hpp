@@ -30,6 +30,7 @@
 #include <iterator>
 #include "Array.hpp"
 #include "Fundamental.hpp"
+#include "SmallVec.hpp"
 #include "Vec.hpp"
 #include "Traits/Functions.hpp"
 #include "_Fwd/ArrayRef.hpp"
@@ -93,7 +94,9 @@ public:
     EFLI_CXPR11ASSERT_(end >= begin);
   }
 
-  // TODO: SmallVec
+  /// Construct from `SmallVec<T, N>`.
+  ArrayRef(SmallVecImpl<T>& vec)
+   : data_(vec.data()), size_(vec.size()) { }
 
   template <typename Alloc>
   EFLI_CXX20_CXPR_ ArrayRef(std::vector<T, Alloc>& vec)
@@ -295,7 +298,9 @@ public:
   constexpr ImmutArrayRef(const T* begin, const T* end) 
    : ArrayRef<const T>(begin, end) { }
 
-  // TODO: SmallVec
+  /// Construct from `SmallVec<T, N>`.
+  ImmutArrayRef(const SmallVecImpl<T>& vec)
+   : ArrayRef<const T>(vec.data(), vec.size()) { }
 
   template <typename Alloc>
   EFLI_CXX20_CXPR_ ImmutArrayRef(
@@ -440,7 +445,17 @@ NODEBUG constexpr ArrayRef<T>
   return ArrayRef<T>(begin, end);
 }
 
-// SmallVec
+template <typename T>
+NODEBUG ArrayRef<T>
+ make_arrayref(SmallVecImpl<T>& vec) NOEXCEPT {
+  return ArrayRef<T>(vec);
+}
+
+template <typename T, H::SzType N>
+NODEBUG ArrayRef<T>
+ make_arrayref(SmallVec<T, N>& vec) NOEXCEPT {
+  return ArrayRef<T>(vec);
+}
 
 template <typename T, typename A>
 NODEBUG EFLI_CXX20_CXPR_ ArrayRef<T>
@@ -476,7 +491,11 @@ ArrayRef(T*, H::SzType) -> ArrayRef<T>;
 template <typename T>
 ArrayRef(T* begin, T* end) -> ArrayRef<T>;
 
-// SmallVec
+template <typename T>
+ArrayRef(SmallVecImpl<T>&) -> ArrayRef<T>;
+
+template <typename T, H::SzType N>
+ArrayRef(SmallVec<T, N>&) -> ArrayRef<T>;
 
 template <typename T, typename A>
 ArrayRef(std::vector<T, A>&) -> ArrayRef<T>;
@@ -508,7 +527,17 @@ NODEBUG constexpr ImmutArrayRef<T>
   return ImmutArrayRef<T>(begin, end);
 }
 
-// SmallVec
+template <typename T>
+NODEBUG ImmutArrayRef<T>
+ make_immutarrayref(const SmallVecImpl<T>& vec) NOEXCEPT {
+  return ImmutArrayRef<T>(vec);
+}
+
+template <typename T, H::SzType N>
+NODEBUG ImmutArrayRef<T>
+ make_immutarrayref(const SmallVec<T, N>& vec) NOEXCEPT {
+  return ImmutArrayRef<T>(vec);
+}
 
 template <typename T, typename A>
 NODEBUG EFLI_CXX20_CXPR_ ImmutArrayRef<T>
@@ -550,7 +579,11 @@ ImmutArrayRef(const T*, H::SzType) -> ImmutArrayRef<T>;
 template <typename T>
 ImmutArrayRef(const T* begin, const T* end) -> ImmutArrayRef<T>;
 
-// SmallVec
+template <typename T>
+ImmutArrayRef(const SmallVecImpl<T>&) -> ImmutArrayRef<T>;
+
+template <typename T, H::SzType N>
+ImmutArrayRef(const SmallVec<T, N>&) -> ImmutArrayRef<T>;
 
 template <typename T, typename A>
 ImmutArrayRef(const std::vector<T, A>&) -> ImmutArrayRef<T>;
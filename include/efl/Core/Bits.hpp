@@ -0,0 +1,106 @@
+//===- Core/Bits.hpp ------------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines constexpr bit counting functions,
+//  mirroring the ones in <bit>. Uses builtins where available.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_BITS_HPP
+#define EFL_CORE_BITS_HPP
+
+#include "Fundamental.hpp"
+#include "Traits/Functions.hpp"
+
+#if __has_builtin(__builtin_ctzll) || defined(__GNUC__)
+# define EFLI_BITS_BUILTIN_ 1
+#else
+# define EFLI_BITS_BUILTIN_ 0
+#endif
+
+namespace efl {
+namespace C {
+namespace H {
+  template <typename T>
+  using IsBitType = BoolC<
+    std::is_unsigned<T>::value && 
+    !std::is_same<T, bool>::value &&
+    (sizeof(T) <= sizeof(u64))>;
+
+  template <typename T>
+  FICONSTEXPR int bit_width_of() NOEXCEPT {
+    return int(sizeof(T) * 8);
+  }
+
+#if EFLI_BITS_BUILTIN_
+  FICONSTEXPR int ctz64(u64 v) NOEXCEPT 
+  { return __builtin_ctzll(v); }
+  FICONSTEXPR int clz64(u64 v) NOEXCEPT 
+  { return __builtin_clzll(v); }
+  FICONSTEXPR int popcnt64(u64 v) NOEXCEPT 
+  { return __builtin_popcountll(v); }
+#else
+  // Only used for nonzero values.
+  FICONSTEXPR int ctz64(u64 v, int n = 0) NOEXCEPT 
+  { return (v & 1) ? n : ctz64(v >> 1, n + 1); }
+  FICONSTEXPR int clz64(u64 v, int n = 0) NOEXCEPT 
+  { return (v >> 63) ? n : clz64(v << 1, n + 1); }
+  FICONSTEXPR int popcnt64(u64 v) NOEXCEPT 
+  { return v ? int(v & 1) + popcnt64(v >> 1) : 0; }
+#endif
+} // namespace H
+
+/// Number of consecutive zero bits, starting from the lowest.
+template <typename T, MEflEnableIf(H::IsBitType<T>::value)>
+FICONSTEXPR int countr_zero(T t) NOEXCEPT {
+  return (t == 0) ? H::bit_width_of<T>() : H::ctz64(u64(t));
+}
+
+/// Number of consecutive zero bits, starting from the highest.
+template <typename T, MEflEnableIf(H::IsBitType<T>::value)>
+FICONSTEXPR int countl_zero(T t) NOEXCEPT {
+  return (t == 0) ? H::bit_width_of<T>() : 
+    H::clz64(u64(t)) - (64 - H::bit_width_of<T>());
+}
+
+/// Number of set bits.
+template <typename T, MEflEnableIf(H::IsBitType<T>::value)>
+FICONSTEXPR int popcount(T t) NOEXCEPT {
+  return H::popcnt64(u64(t));
+}
+
+/// Number of bits needed to represent `t`.
+template <typename T, MEflEnableIf(H::IsBitType<T>::value)>
+FICONSTEXPR int bit_width(T t) NOEXCEPT {
+  return H::bit_width_of<T>() - countl_zero(t);
+}
+
+/// Smallest power of 2 not less than `t`.
+template <typename T, MEflEnableIf(H::IsBitType<T>::value)>
+FICONSTEXPR T bit_ceil(T t) NOEXCEPT {
+  return (t <= 1) ? T(1) : T(T(1) << bit_width(T(t - 1)));
+}
+
+} // namespace C
+} // namespace efl
+
+#undef EFLI_BITS_BUILTIN_
+
+#endif // EFL_CORE_BITS_HPP
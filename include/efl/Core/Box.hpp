@@ -31,6 +31,18 @@
 
 namespace efl {
 namespace C {
+namespace H {
+  /// Checks if `A` can release objects owned by a `Box`.
+  /// Only `Delete` must be static, allocation may be stateful.
+  template <typename A, typename = void>
+  struct IsBoxAllocator : H::FalseType { };
+
+  template <typename A>
+  struct IsBoxAllocator<A, void_t<decltype(
+    A::Delete(Decl<typename A::pointer>()))>>
+   : H::TrueType { };
+} // namespace H
+
 /**
  * 
  */
@@ -66,6 +78,8 @@ struct GSL_OWNER NODISCARD Box {
   using element_type = T;
   using pointer = element_type*;
   using allocator_type = A;
+  template <typename, typename>
+  friend struct Box;
 public:
   constexpr Box() = default;
   Box(const Box&) = delete;
@@ -112,7 +126,7 @@ public:
   template <typename Alloc, typename...Args>
   NODISCARD static Box<T, Alloc> 
    NewIn(Alloc alloc, Args&&...args) {
-    MEflESAssert(H::IsStatelessAllocator<Alloc>::value);
+    MEflESAssert(H::IsBoxAllocator<Alloc>::value);
     using PtrType = typename Alloc::pointer;
     PtrType p = alloc.New(FWD_CAST(args)...);
     return Box<T, Alloc>(p);
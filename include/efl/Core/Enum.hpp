@@ -39,7 +39,9 @@
  * efl::Enum<SigTokenAttr>::HasFlag(tok.attr);
  */
 
+#include "Enum/EnumArray.hpp"
 #include "Enum/EnumsAndFlags.hpp"
+#include "Enum/FlagSet.hpp"
 #include "Enum/Overloads.hpp"
 
 namespace efl {
@@ -17,26 +17,384 @@
 //===----------------------------------------------------------------===//
 //
 //  This file defines utilities for creating a statically-sized
-//  array that accepts enumeration values.
+//  array that accepts enumeration values, and a bitset keyed
+//  by the same values.
 //
 //===----------------------------------------------------------------===//
 
 #pragma once
 
-#ifndef EFL_CORE_ENUM_FLAGS_HPP
-#define EFL_CORE_ENUM_FLAGS_HPP
+#ifndef EFL_CORE_ENUM_ENUMARRAY_HPP
+#define EFL_CORE_ENUM_ENUMARRAY_HPP
 
+#include <iterator>
+#include "EnumsAndFlags.hpp"
 #include "Macros.hpp"
+#include <efl/Core/Array.hpp>
+#include <efl/Core/Bits.hpp>
 #include <efl/Core/_Cxx11Assert.hpp>
 #include <efl/Core/Traits/Functions.hpp>
 
+EFLI_CXPR11ASSERT_PROLOGUE_
+
 namespace efl {
 namespace C {
+namespace H {
+  /// Number of slots needed to index every value up to `MaxValue`.
+  template <typename E>
+  FICONSTEXPR SzType enum_extent() NOEXCEPT {
+    return SzType(largest_marked_value<E>::value) + 1;
+  }
+
+  /// Slot of `e`. Negative values wrap, and fail the bounds check.
+  template <typename E>
+  FICONSTEXPR SzType enum_index(E e) NOEXCEPT {
+    return SzType(u64(underlying(e)));
+  }
+
+  template <typename E>
+  struct EnumSetIter {
+    using value_type = E;
+    using difference_type = std::ptrdiff_t;
+    using reference = E;
+    using pointer = void;
+    using iterator_category = std::forward_iterator_tag;
+  public:
+    EnumSetIter() = default;
+    EFLI_CXX14_CXPR_ EnumSetIter(
+     const u64* words, SzType word, SzType count) NOEXCEPT
+     : words_(words), word_(word), count_(count),
+     bits_(word < count ? words[word] : 0) {
+      this->skipEmpty();
+    }
+
+    constexpr E operator*() const NOEXCEPT {
+      return E(word_ * 64 + SzType(countr_zero(bits_)));
+    }
+
+    EFLI_CXX14_CXPR_ EnumSetIter& operator++() NOEXCEPT {
+      this->bits_ &= (bits_ - 1);
+      this->skipEmpty();
+      return *this;
+    }
+
+    EFLI_CXX14_CXPR_ EnumSetIter operator++(int) NOEXCEPT {
+      EnumSetIter it = *this;
+      ++*this;
+      return it;
+    }
+
+    friend constexpr bool operator==(
+     const EnumSetIter& l, const EnumSetIter& r) NOEXCEPT {
+      return (l.word_ == r.word_) && (l.bits_ == r.bits_);
+    }
+
+    friend constexpr bool operator!=(
+     const EnumSetIter& l, const EnumSetIter& r) NOEXCEPT {
+      return !(l == r);
+    }
+
+  private:
+    EFLI_CXX14_CXPR_ void skipEmpty() NOEXCEPT {
+      while(bits_ == 0 && word_ < count_) {
+        if(++this->word_ == count_)
+          break;
+        this->bits_ = words_[word_];
+      }
+    }
+
+  private:
+    const u64* words_ = nullptr;
+    SzType word_ = 0;
+    SzType count_ = 0;
+    u64 bits_ = 0;
+  };
+} // namespace H
+
+/**
+ * @name EnumArray
+ * @brief Statically sized array indexed by a marked enum.
+ * 
+ * Holds a slot for every value in `[0, MaxValue]`, so lookups
+ * are a single indexed load. Internals are public, meaning
+ * it can be aggregate initialized in declaration order.
+ */
+template <typename E, typename T>
+struct EnumArray {
+  static_assert(is_marked_enum<E>::value,
+    "EnumArray requires an enum marked with MEflEnumEnd.");
+  using Type = T;
+  using KeyType = E;
+  using ArrayType = Array<T, H::enum_extent<E>()>;
+  using value_type = T;
+  using iterator = typename ArrayType::iterator;
+  using const_iterator = typename ArrayType::const_iterator;
+  using size_type = H::SzType;
+public:
+  //=== Iterators ===//
+
+  EFLI_CXX17_CXPR_ iterator begin() NOEXCEPT
+  { return data_.begin(); }
+
+  EFLI_CXX17_CXPR_ iterator end() NOEXCEPT
+  { return data_.end(); }
+
+  EFLI_CXX17_CXPR_ const_iterator begin() const NOEXCEPT
+  { return data_.begin(); }
+
+  EFLI_CXX17_CXPR_ const_iterator end() const NOEXCEPT
+  { return data_.end(); }
+
+  //=== Element Access ===//
+
+  /// Get the element keyed by `e`, returns `T&`.
+  NODISCARD EFLI_CXX17_CXPR_ T& operator[](E e) NOEXCEPT {
+    EFLI_CXPR11ASSERT_(H::enum_index(e) < Size());
+    return data_[H::enum_index(e)];
+  }
+
+  /// Get the element keyed by `e`, returns `const T&`.
+  NODISCARD constexpr const T& operator[](E e) const NOEXCEPT {
+    EFLI_CXPR11ASSERT_(H::enum_index(e) < Size());
+    return data_[H::enum_index(e)];
+  }
+
+  NODISCARD EFLI_CXX17_CXPR_ T* data() NOEXCEPT
+  { return data_.data(); }
+
+  NODISCARD EFLI_CXX17_CXPR_ const T* data() const NOEXCEPT
+  { return data_.data(); }
+
+  /// Calls `fn(E, T&)` for every slot, in index order.
+  template <typename F>
+  EFLI_CXX17_CXPR_ void forEach(F&& fn) {
+    for(size_type I = 0; I < Size(); ++I)
+      fn(E(I), data_[I]);
+  }
+
+  /// Calls `fn(E, const T&)` for every slot, in index order.
+  template <typename F>
+  EFLI_CXX17_CXPR_ void forEach(F&& fn) const {
+    for(size_type I = 0; I < Size(); ++I)
+      fn(E(I), data_[I]);
+  }
+
+  //=== Observers ===//
+
+  FICONSTEXPR static size_type Size() NOEXCEPT
+  { return H::enum_extent<E>(); }
+
+  FICONSTEXPR size_type size() const NOEXCEPT
+  { return Size(); }
+
+  //=== Modifiers ===//
+
+  EFLI_CXX20_CXPR_ void fill(const T& t) {
+    data_.fill(t);
+  }
+
+  friend bool operator==(
+   const EnumArray& l, const EnumArray& r) {
+    return l.data_ == r.data_;
+  }
+
+#if CPPVER_MOST(17)
+  friend bool operator!=(
+   const EnumArray& l, const EnumArray& r) {
+    return l.data_ != r.data_;
+  }
+#endif // Three-way Comparison Check (C++20)
+
+public:
+  ArrayType data_;
+};
+
+/**
+ * @name EnumSet
+ * @brief Bitset keyed by a marked enum.
+ * 
+ * Each value in `[0, MaxValue]` owns one bit. Iteration and
+ * counting walk whole words with ctz/popcount, so sparse
+ * sets cost one step per member rather than per value.
+ */
+template <typename E>
+struct EnumSet {
+  static_assert(is_marked_enum<E>::value,
+    "EnumSet requires an enum marked with MEflEnumEnd.");
+  using KeyType = E;
+  using value_type = E;
+  using iterator = H::EnumSetIter<E>;
+  using const_iterator = iterator;
+  using size_type = H::SzType;
+  static constexpr size_type wordCount = 
+    (H::enum_extent<E>() + 63) / 64;
+public:
+  constexpr EnumSet() = default;
+
+  EFLI_CXX14_CXPR_ EnumSet(H::InitList<E> il) NOEXCEPT {
+    for(E e : il)
+      this->insert(e);
+  }
+
+  /// Set with every value in `[0, MaxValue]`.
+  NODISCARD EFLI_CXX14_CXPR_ static EnumSet All() NOEXCEPT {
+    EnumSet set {};
+    for(size_type I = 0; I < wordCount; ++I)
+      set.words_[I] = ~u64(0);
+    const size_type tail = Size() % 64;
+    if(tail != 0)
+      set.words_[wordCount - 1] = (u64(1) << tail) - 1;
+    return set;
+  }
+
+  //=== Iterators ===//
+
+  EFLI_CXX14_CXPR_ iterator begin() const NOEXCEPT
+  { return iterator(words_, 0, wordCount); }
+
+  EFLI_CXX14_CXPR_ iterator end() const NOEXCEPT
+  { return iterator(words_, wordCount, wordCount); }
+
+  /// Calls `fn(E)` for every member, in index order.
+  template <typename F>
+  EFLI_CXX14_CXPR_ void forEach(F&& fn) const {
+    for(size_type I = 0; I < wordCount; ++I) {
+      u64 bits = words_[I];
+      while(bits != 0) {
+        fn(E(I * 64 + size_type(countr_zero(bits))));
+        bits &= (bits - 1);
+      }
+    }
+  }
+
+  //=== Observers ===//
+
+  NODISCARD constexpr bool contains(E e) const NOEXCEPT {
+    EFLI_CXPR11ASSERT_(H::enum_index(e) < Size());
+    return (words_[WordOf(e)] & MaskOf(e)) != 0;
+  }
+
+  /// Number of members.
+  NODISCARD EFLI_CXX14_CXPR_ size_type count() const NOEXCEPT {
+    size_type total = 0;
+    for(size_type I = 0; I < wordCount; ++I)
+      total += size_type(popcount(words_[I]));
+    return total;
+  }
+
+  NODISCARD EFLI_CXX14_CXPR_ bool isEmpty() const NOEXCEPT {
+    for(size_type I = 0; I < wordCount; ++I) {
+      if(words_[I] != 0)
+        return false;
+    }
+    return true;
+  }
+
+  FICONSTEXPR static size_type Size() NOEXCEPT
+  { return H::enum_extent<E>(); }
+
+  //=== Modifiers ===//
+
+  EFLI_CXX14_CXPR_ EnumSet& insert(E e) NOEXCEPT {
+    EFLI_CXPR11ASSERT_(H::enum_index(e) < Size());
+    this->words_[WordOf(e)] |= MaskOf(e);
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ EnumSet& erase(E e) NOEXCEPT {
+    EFLI_CXPR11ASSERT_(H::enum_index(e) < Size());
+    this->words_[WordOf(e)] &= ~MaskOf(e);
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ EnumSet& toggle(E e) NOEXCEPT {
+    EFLI_CXPR11ASSERT_(H::enum_index(e) < Size());
+    this->words_[WordOf(e)] ^= MaskOf(e);
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ void clear() NOEXCEPT {
+    for(size_type I = 0; I < wordCount; ++I)
+      this->words_[I] = 0;
+  }
+
+  //=== Set Algebra ===//
+
+  EFLI_CXX14_CXPR_ EnumSet& operator|=(const EnumSet& r) NOEXCEPT {
+    for(size_type I = 0; I < wordCount; ++I)
+      this->words_[I] |= r.words_[I];
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ EnumSet& operator&=(const EnumSet& r) NOEXCEPT {
+    for(size_type I = 0; I < wordCount; ++I)
+      this->words_[I] &= r.words_[I];
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ EnumSet& operator^=(const EnumSet& r) NOEXCEPT {
+    for(size_type I = 0; I < wordCount; ++I)
+      this->words_[I] ^= r.words_[I];
+    return *this;
+  }
+
+  /// Removes every member of `r`.
+  EFLI_CXX14_CXPR_ EnumSet& operator-=(const EnumSet& r) NOEXCEPT {
+    for(size_type I = 0; I < wordCount; ++I)
+      this->words_[I] &= ~r.words_[I];
+    return *this;
+  }
+
+  friend EFLI_CXX14_CXPR_ EnumSet operator|(
+   EnumSet l, const EnumSet& r) NOEXCEPT {
+    return l |= r;
+  }
+
+  friend EFLI_CXX14_CXPR_ EnumSet operator&(
+   EnumSet l, const EnumSet& r) NOEXCEPT {
+    return l &= r;
+  }
+
+  friend EFLI_CXX14_CXPR_ EnumSet operator^(
+   EnumSet l, const EnumSet& r) NOEXCEPT {
+    return l ^= r;
+  }
+
+  friend EFLI_CXX14_CXPR_ EnumSet operator-(
+   EnumSet l, const EnumSet& r) NOEXCEPT {
+    return l -= r;
+  }
+
+  friend EFLI_CXX14_CXPR_ bool operator==(
+   const EnumSet& l, const EnumSet& r) NOEXCEPT {
+    for(size_type I = 0; I < wordCount; ++I) {
+      if(l.words_[I] != r.words_[I])
+        return false;
+    }
+    return true;
+  }
+
+#if CPPVER_MOST(17)
+  friend EFLI_CXX14_CXPR_ bool operator!=(
+   const EnumSet& l, const EnumSet& r) NOEXCEPT {
+    return !(l == r);
+  }
+#endif // Three-way Comparison Check (C++20)
+
+private:
+  FICONSTEXPR static size_type WordOf(E e) NOEXCEPT
+  { return H::enum_index(e) / 64; }
+
+  FICONSTEXPR static u64 MaskOf(E e) NOEXCEPT
+  { return u64(1) << (H::enum_index(e) % 64); }
 
+private:
+  u64 words_[wordCount] { };
+};
 
 } // namespace C
 } // namespace efl
 
 EFLI_CXPR11ASSERT_EPILOGUE_
 
-#endif // EFL_CORE_ENUM_FLAGS_HPP
+#endif // EFL_CORE_ENUM_ENUMARRAY_HPP
@@ -0,0 +1,239 @@
+//===- Core/Enum/FlagSet.hpp ----------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines FlagSet, a constexpr container over the
+//  bits of a flagged enum.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_ENUM_FLAGSET_HPP
+#define EFL_CORE_ENUM_FLAGSET_HPP
+
+#include "EnumsAndFlags.hpp"
+#include "Macros.hpp"
+#include <efl/Core/Bits.hpp>
+#include <efl/Core/_Cxx11Assert.hpp>
+#include <efl/Core/Traits/Functions.hpp>
+
+EFLI_CXPR11ASSERT_PROLOGUE_
+
+namespace efl {
+namespace C {
+/**
+ * @name FlagSet
+ * @brief Set of flags from an enum marked with MEflFlagEnd.
+ * 
+ * Stores the raw underlying bits, so every query is a single
+ * mask and compare. Bits outside `flag_mask<E>()` are rejected
+ * on construction and stripped by complement.
+ */
+template <typename E>
+struct FlagSet {
+  static_assert(is_flagged_enum<E>::value,
+    "FlagSet requires an enum marked with MEflFlagEnd.");
+  using KeyType = E;
+  using UndType = underlying_type_t<E>;
+  using size_type = H::SzType;
+private:
+  struct RawTag { };
+  constexpr FlagSet(RawTag, UndType bits) NOEXCEPT
+   : bits_(bits) { }
+public:
+  constexpr FlagSet() = default;
+
+  constexpr FlagSet(E e) NOEXCEPT
+   : bits_(H::underlying(e)) { }
+
+  EFLI_CXX14_CXPR_ FlagSet(H::InitList<E> il) NOEXCEPT {
+    for(E e : il)
+      this->bits_ |= H::underlying(e);
+  }
+
+  /// Set with every declared flag.
+  NODISCARD FICONSTEXPR static FlagSet All() NOEXCEPT {
+    return FlagSet(RawTag{}, Mask());
+  }
+
+  /// Set from raw bits, which must all be declared flags.
+  NODISCARD FICONSTEXPR static FlagSet 
+   FromBits(UndType bits) NOEXCEPT {
+    EFLI_CXPR11ASSERT_(IsValid(bits));
+    return FlagSet(RawTag{}, bits);
+  }
+
+  /// Set from raw bits, dropping any undeclared ones.
+  NODISCARD FICONSTEXPR static FlagSet 
+   FromBitsTruncate(UndType bits) NOEXCEPT {
+    return FlagSet(RawTag{}, UndType(bits & Mask()));
+  }
+
+  /// Checks that `bits` only contains declared flags.
+  NODISCARD FICONSTEXPR static bool 
+   IsValid(UndType bits) NOEXCEPT {
+    return UndType(bits & UndType(~Mask())) == 0;
+  }
+
+  FICONSTEXPR static UndType Mask() NOEXCEPT {
+    return H::flag_mask<E>();
+  }
+
+  //=== Observers ===//
+
+  /// Checks if every bit of `e` is set.
+  NODISCARD constexpr bool has(E e) const NOEXCEPT {
+    return UndType(bits_ & H::underlying(e)) == H::underlying(e);
+  }
+
+  /// Checks if every flag in `r` is set.
+  NODISCARD constexpr bool has(FlagSet r) const NOEXCEPT {
+    return UndType(bits_ & r.bits_) == r.bits_;
+  }
+
+  /// Checks if any flag in `r` is set.
+  NODISCARD constexpr bool hasAny(FlagSet r) const NOEXCEPT {
+    return UndType(bits_ & r.bits_) != 0;
+  }
+
+  NODISCARD constexpr bool isEmpty() const NOEXCEPT {
+    return bits_ == 0;
+  }
+
+  /// Number of set bits.
+  NODISCARD constexpr size_type count() const NOEXCEPT {
+    return size_type(popcount(bits_));
+  }
+
+  NODISCARD constexpr UndType bits() const NOEXCEPT {
+    return bits_;
+  }
+
+  constexpr explicit operator bool() const NOEXCEPT {
+    return bits_ != 0;
+  }
+
+  /// Calls `fn(E)` for every set bit, lowest first.
+  template <typename F>
+  EFLI_CXX14_CXPR_ void forEachSet(F&& fn) const {
+    UndType bits = bits_;
+    while(bits != 0) {
+      fn(E(UndType(UndType(1) << countr_zero(bits))));
+      bits &= UndType(bits - 1);
+    }
+  }
+
+  //=== Modifiers ===//
+
+  EFLI_CXX14_CXPR_ FlagSet& set(E e) NOEXCEPT {
+    this->bits_ |= H::underlying(e);
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ FlagSet& unset(E e) NOEXCEPT {
+    this->bits_ &= UndType(~H::underlying(e));
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ FlagSet& toggle(E e) NOEXCEPT {
+    this->bits_ ^= H::underlying(e);
+    return *this;
+  }
+
+  /// Sets or unsets `e` without branching on `on`.
+  EFLI_CXX14_CXPR_ FlagSet& setTo(E e, bool on) NOEXCEPT {
+    const UndType f = H::underlying(e);
+    const UndType fill = UndType(UndType(0) - UndType(on));
+    this->bits_ = UndType((bits_ & UndType(~f)) | (f & fill));
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ void clear() NOEXCEPT {
+    this->bits_ = 0;
+  }
+
+  //=== Set Algebra ===//
+
+  EFLI_CXX14_CXPR_ FlagSet& operator|=(FlagSet r) NOEXCEPT {
+    this->bits_ |= r.bits_;
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ FlagSet& operator&=(FlagSet r) NOEXCEPT {
+    this->bits_ &= r.bits_;
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ FlagSet& operator^=(FlagSet r) NOEXCEPT {
+    this->bits_ ^= r.bits_;
+    return *this;
+  }
+
+  /// Removes every flag in `r`.
+  EFLI_CXX14_CXPR_ FlagSet& operator-=(FlagSet r) NOEXCEPT {
+    this->bits_ &= UndType(~r.bits_);
+    return *this;
+  }
+
+  friend constexpr FlagSet operator|(
+   FlagSet l, FlagSet r) NOEXCEPT {
+    return FlagSet(RawTag{}, UndType(l.bits_ | r.bits_));
+  }
+
+  friend constexpr FlagSet operator&(
+   FlagSet l, FlagSet r) NOEXCEPT {
+    return FlagSet(RawTag{}, UndType(l.bits_ & r.bits_));
+  }
+
+  friend constexpr FlagSet operator^(
+   FlagSet l, FlagSet r) NOEXCEPT {
+    return FlagSet(RawTag{}, UndType(l.bits_ ^ r.bits_));
+  }
+
+  friend constexpr FlagSet operator-(
+   FlagSet l, FlagSet r) NOEXCEPT {
+    return FlagSet(RawTag{}, UndType(l.bits_ & ~r.bits_));
+  }
+
+  /// Complement within `flag_mask<E>()`.
+  friend constexpr FlagSet operator~(FlagSet r) NOEXCEPT {
+    return FlagSet(RawTag{}, UndType(~r.bits_ & Mask()));
+  }
+
+  friend constexpr bool operator==(
+   FlagSet l, FlagSet r) NOEXCEPT {
+    return l.bits_ == r.bits_;
+  }
+
+#if CPPVER_MOST(17)
+  friend constexpr bool operator!=(
+   FlagSet l, FlagSet r) NOEXCEPT {
+    return l.bits_ != r.bits_;
+  }
+#endif // Three-way Comparison Check (C++20)
+
+private:
+  UndType bits_ = 0;
+};
+
+} // namespace C
+} // namespace efl
+
+EFLI_CXPR11ASSERT_EPILOGUE_
+
+#endif // EFL_CORE_ENUM_FLAGSET_HPP
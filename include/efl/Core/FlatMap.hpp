@@ -0,0 +1,802 @@
+//===- Core/FlatMap.hpp ---------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines FlatMap<...> and FlatSet<...>, open addressing
+//  hash tables in the style of abseil's Swiss tables. Control bytes
+//  are probed 16 at a time, with SSE2 where available.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_FLATMAP_HPP
+#define EFL_CORE_FLATMAP_HPP
+
+#include <cstring>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include "Bits.hpp"
+#include "Hash.hpp"
+#include "MimAllocator.hpp"
+#include "RelocVec.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+ (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+# include <emmintrin.h>
+# define EFLI_FLATMAP_SSE2_ 1
+#else
+# define EFLI_FLATMAP_SSE2_ 0
+#endif
+
+namespace efl {
+namespace C {
+namespace H {
+  /// Empty and deleted slots have the high bit set,
+  /// full slots store the low 7 bits of the hash.
+  using FlatCtrl = i8;
+  GLOBAL FlatCtrl flat_empty = -128;
+  GLOBAL FlatCtrl flat_deleted = -2;
+  GLOBAL FlatCtrl flat_sentinel = -1;
+  GLOBAL SzType flat_group_width = 16;
+  GLOBAL SzType flat_min_capacity = 16;
+
+#if EFLI_FLATMAP_SSE2_
+  /// Matches 16 control bytes at once.
+  struct FlatGroup {
+    explicit FlatGroup(const FlatCtrl* p) NOEXCEPT
+     : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) { }
+
+    ALWAYS_INLINE u32 match(FlatCtrl h2) const NOEXCEPT {
+      return u32(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+    }
+
+    ALWAYS_INLINE u32 matchEmpty() const NOEXCEPT {
+      return this->match(flat_empty);
+    }
+
+    ALWAYS_INLINE u32 matchEmptyOrDeleted() const NOEXCEPT {
+      return u32(_mm_movemask_epi8(
+        _mm_cmpgt_epi8(_mm_set1_epi8(flat_sentinel), ctrl_)));
+    }
+  public:
+    __m128i ctrl_;
+  };
+#else
+  /// Portable fallback, matches one byte at a time.
+  struct FlatGroup {
+    explicit FlatGroup(const FlatCtrl* p) NOEXCEPT {
+      std::memcpy(ctrl_, p, flat_group_width);
+    }
+
+    ALWAYS_INLINE u32 match(FlatCtrl h2) const NOEXCEPT {
+      u32 mask = 0;
+      for(SzType I = 0; I < flat_group_width; ++I)
+        mask |= u32(ctrl_[I] == h2) << I;
+      return mask;
+    }
+
+    ALWAYS_INLINE u32 matchEmpty() const NOEXCEPT {
+      return this->match(flat_empty);
+    }
+
+    ALWAYS_INLINE u32 matchEmptyOrDeleted() const NOEXCEPT {
+      u32 mask = 0;
+      for(SzType I = 0; I < flat_group_width; ++I)
+        mask |= u32(ctrl_[I] < flat_sentinel) << I;
+      return mask;
+    }
+  public:
+    FlatCtrl ctrl_[flat_group_width];
+  };
+#endif
+
+  /// Triangular probing over groups, visits every group
+  /// exactly once when the capacity is a power of 2.
+  struct FlatProbe {
+    FlatProbe(SzType hash, SzType mask) NOEXCEPT
+     : mask_(mask), offset_(hash & mask) { }
+    SzType offset() const NOEXCEPT { return offset_; }
+    SzType offset(SzType I) const NOEXCEPT {
+      return (offset_ + I) & mask_;
+    }
+    void next() NOEXCEPT {
+      this->index_ += flat_group_width;
+      this->offset_ = (offset_ + index_) & mask_;
+    }
+  public:
+    SzType mask_;
+    SzType offset_;
+    SzType index_ = 0;
+  };
+
+  /// Control bytes for tables with no allocation.
+  /// Only read, so lookups don't need to check for null.
+  inline const FlatCtrl* flat_empty_group() NOEXCEPT {
+    alignas(16) static const FlatCtrl group[flat_group_width] {
+      flat_empty, flat_empty, flat_empty, flat_empty,
+      flat_empty, flat_empty, flat_empty, flat_empty,
+      flat_empty, flat_empty, flat_empty, flat_empty,
+      flat_empty, flat_empty, flat_empty, flat_empty
+    };
+    return group;
+  }
+
+  /// Tables hold at most 7/8ths of their capacity.
+  FICONSTEXPR SzType flat_max_load(SzType cap) NOEXCEPT {
+    return cap - cap / 8;
+  }
+
+  template <typename HashFn, typename EqFn, typename = void>
+  struct IsFlatTransparent : FalseType { };
+
+  template <typename HashFn, typename EqFn>
+  struct IsFlatTransparent<HashFn, EqFn, void_t<
+    typename HashFn::is_transparent, 
+    typename EqFn::is_transparent>> : TrueType { };
+
+  template <typename Slot, bool IsConst>
+  struct FlatIter {
+    using value_type = Slot;
+    using difference_type = std::ptrdiff_t;
+    using reference = conditional_t<IsConst, const Slot&, Slot&>;
+    using pointer = conditional_t<IsConst, const Slot*, Slot*>;
+    using iterator_category = std::forward_iterator_tag;
+  public:
+    FlatIter() = default;
+    /// Starts at `slot`, skipping to the next full slot.
+    FlatIter(const FlatCtrl* ctrl, pointer slot, 
+     const FlatCtrl* end) NOEXCEPT
+     : ctrl_(ctrl), slot_(slot), end_(end) {
+      this->skipEmpty();
+    }
+
+    template <bool WasConst, MEflEnableIf(IsConst && !WasConst)>
+    FlatIter(const FlatIter<Slot, WasConst>& it) NOEXCEPT
+     : ctrl_(it.ctrl_), slot_(it.slot_), end_(it.end_) { }
+
+    reference operator*() const NOEXCEPT { return *slot_; }
+    pointer operator->() const NOEXCEPT { return slot_; }
+
+    FlatIter& operator++() NOEXCEPT {
+      ++this->ctrl_;
+      ++this->slot_;
+      this->skipEmpty();
+      return *this;
+    }
+
+    FlatIter operator++(int) NOEXCEPT {
+      FlatIter it = *this;
+      ++*this;
+      return it;
+    }
+
+    friend bool operator==(
+     const FlatIter& l, const FlatIter& r) NOEXCEPT {
+      return l.slot_ == r.slot_;
+    }
+
+    friend bool operator!=(
+     const FlatIter& l, const FlatIter& r) NOEXCEPT {
+      return l.slot_ != r.slot_;
+    }
+
+  private:
+    void skipEmpty() NOEXCEPT {
+      while(ctrl_ != end_ && *ctrl_ < 0) {
+        ++this->ctrl_;
+        ++this->slot_;
+      }
+    }
+
+  public:
+    const FlatCtrl* ctrl_ = nullptr;
+    pointer slot_ = nullptr;
+    const FlatCtrl* end_ = nullptr;
+  };
+
+  template <typename K, typename V>
+  struct FlatMapPolicy {
+    using KeyType = K;
+    using SlotType = std::pair<K, V>;
+
+    static const K& Key(const SlotType& slot) NOEXCEPT {
+      return slot.first;
+    }
+
+    template <typename KK, typename...Args>
+    static void Construct(SlotType* p, KK&& key, Args&&...args) {
+      (void) X11::construct(p, std::piecewise_construct,
+        std::forward_as_tuple(FWD_CAST(key)),
+        std::forward_as_tuple(FWD_CAST(args)...));
+    }
+  };
+
+  template <typename K>
+  struct FlatSetPolicy {
+    using KeyType = K;
+    using SlotType = K;
+
+    static const K& Key(const SlotType& slot) NOEXCEPT {
+      return slot;
+    }
+
+    template <typename KK>
+    static void Construct(SlotType* p, KK&& key) {
+      (void) X11::construct(p, FWD_CAST(key));
+    }
+  };
+
+  /**
+   * @brief Shared implementation of `FlatMap` and `FlatSet`.
+   * 
+   * Slots and control bytes live in a single block, slots first.
+   * The first 15 control bytes are cloned after the last one,
+   * so a group can be loaded at any offset.
+   */
+  template <typename Policy, typename HashFn, typename EqFn>
+  struct FlatTable {
+    using KeyType = typename Policy::KeyType;
+    using SlotType = typename Policy::SlotType;
+    using value_type = SlotType;
+    using size_type = SzType;
+    using hasher = HashFn;
+    using key_equal = EqFn;
+    using iterator = FlatIter<SlotType, false>;
+    using const_iterator = FlatIter<SlotType, true>;
+    using Alloc = MimAllocator<ubyte, alignof(SlotType)>;
+    static constexpr size_type npos = ~size_type(0);
+  private:
+    /// Iterators must still pick `erase(const_iterator)`.
+    template <typename K2>
+    using EnableTransparent = enable_if_t<
+      IsFlatTransparent<HashFn, EqFn>::value &&
+      !std::is_convertible<const K2&, const_iterator>::value, K2>;
+  public:
+    FlatTable() = default;
+
+    explicit FlatTable(size_type n, 
+     const HashFn& hash = HashFn(), const EqFn& eq = EqFn()) 
+     : hash_(hash), eq_(eq) {
+      this->reserve(n);
+    }
+
+    FlatTable(const FlatTable& rhs) 
+     : hash_(rhs.hash_), eq_(rhs.eq_) {
+      this->copyFrom(rhs);
+    }
+
+    FlatTable(FlatTable&& rhs) NOEXCEPT 
+     : hash_(rhs.hash_), eq_(rhs.eq_) {
+      this->steal(rhs);
+    }
+
+    FlatTable& operator=(const FlatTable& rhs) {
+      if(EFL_UNLIKELY(this == &rhs))
+        return *this;
+      this->clear();
+      this->hash_ = rhs.hash_;
+      this->eq_ = rhs.eq_;
+      this->copyFrom(rhs);
+      return *this;
+    }
+
+    FlatTable& operator=(FlatTable&& rhs) NOEXCEPT {
+      if(EFL_UNLIKELY(this == &rhs))
+        return *this;
+      this->release();
+      this->hash_ = rhs.hash_;
+      this->eq_ = rhs.eq_;
+      this->steal(rhs);
+      return *this;
+    }
+
+    ~FlatTable() { this->release(); }
+
+    //=== Iterators ===//
+
+    iterator begin() NOEXCEPT 
+    { return iterator(ctrl_, slots_, ctrl_ + capacity_); }
+    iterator end() NOEXCEPT 
+    { return this->iteratorAt(capacity_); }
+    const_iterator begin() const NOEXCEPT 
+    { return const_iterator(ctrl_, slots_, ctrl_ + capacity_); }
+    const_iterator end() const NOEXCEPT 
+    { return this->iteratorAt(capacity_); }
+
+    //=== Observers ===//
+
+    size_type size() const NOEXCEPT { return size_; }
+    size_type capacity() const NOEXCEPT { return capacity_; }
+    bool isEmpty() const NOEXCEPT { return size_ == 0; }
+    const HashFn& hash_function() const NOEXCEPT { return hash_; }
+    const EqFn& key_eq() const NOEXCEPT { return eq_; }
+
+    //=== Lookup ===//
+
+    iterator find(const KeyType& key) {
+      return this->iteratorAt(this->findIndex(key));
+    }
+
+    const_iterator find(const KeyType& key) const {
+      return this->iteratorAt(this->findIndex(key));
+    }
+
+    /// Heterogeneous lookup, eg. `StrRef` for `Str` keys.
+    template <typename K2, typename = EnableTransparent<K2>>
+    iterator find(const K2& key) {
+      return this->iteratorAt(this->findIndex(key));
+    }
+
+    template <typename K2, typename = EnableTransparent<K2>>
+    const_iterator find(const K2& key) const {
+      return this->iteratorAt(this->findIndex(key));
+    }
+
+    bool contains(const KeyType& key) const {
+      return this->findIndex(key) != npos;
+    }
+
+    template <typename K2, typename = EnableTransparent<K2>>
+    bool contains(const K2& key) const {
+      return this->findIndex(key) != npos;
+    }
+
+    //=== Modifiers ===//
+
+    /// Removes `key` if it exists, returns the number removed.
+    size_type erase(const KeyType& key) {
+      return this->eraseKey(key);
+    }
+
+    template <typename K2, typename = EnableTransparent<K2>>
+    size_type erase(const K2& key) {
+      return this->eraseKey(key);
+    }
+
+    /// Removes the element at `it`, returns the next element.
+    iterator erase(const_iterator it) {
+      const auto I = size_type(it.slot_ - slots_);
+      this->eraseAt(I);
+      return iterator(ctrl_ + I, slots_ + I, ctrl_ + capacity_);
+    }
+
+    void clear() NOEXCEPT {
+      if(!capacity_) return;
+      this->destroyAll();
+      std::memset(ctrl_, flat_empty, 
+        capacity_ + flat_group_width - 1);
+      this->size_ = 0;
+      this->growthLeft_ = flat_max_load(capacity_);
+    }
+
+    /// Ensures `n` elements can be inserted without rehashing.
+    void reserve(size_type n) {
+      if(n > size_ + growthLeft_)
+        this->resize(FlatTable::CapacityFor(n > size_ ? n : size_));
+    }
+
+    /// Rebuilds the table with room for at least `n` elements,
+    /// dropping every tombstone. `rehash(0)` shrinks to fit.
+    void rehash(size_type n) {
+      const size_type m = (n > size_) ? n : size_;
+      if(m == 0) return this->release();
+      this->resize(FlatTable::CapacityFor(m));
+    }
+
+    void swap(FlatTable& rhs) NOEXCEPT {
+      std::swap(this->hash_, rhs.hash_);
+      std::swap(this->eq_, rhs.eq_);
+      std::swap(this->ctrl_, rhs.ctrl_);
+      std::swap(this->slots_, rhs.slots_);
+      std::swap(this->size_, rhs.size_);
+      std::swap(this->capacity_, rhs.capacity_);
+      std::swap(this->growthLeft_, rhs.growthLeft_);
+    }
+
+  protected:
+    struct FindResult {
+      size_type index;
+      bool inserted;
+    };
+
+    /// Finds `key`, or claims a slot for it. The caller must
+    /// construct the slot when `inserted` is true.
+    template <typename K2>
+    FindResult findOrPrepareInsert(const K2& key) {
+      const size_type hash = hash_(key);
+      const size_type I = this->findIndex(key, hash);
+      if(I != npos)
+        return { I, false };
+      return { this->prepareInsert(hash), true };
+    }
+
+    SlotType* slotAt(size_type I) NOEXCEPT {
+      return slots_ + I;
+    }
+
+    iterator iteratorAt(size_type I) NOEXCEPT {
+      if(I == npos) I = capacity_;
+      iterator it {};
+      it.ctrl_ = ctrl_ + I;
+      it.slot_ = slots_ + I;
+      it.end_ = ctrl_ + capacity_;
+      return it;
+    }
+
+    const_iterator iteratorAt(size_type I) const NOEXCEPT {
+      return const_cast<FlatTable*>(this)->iteratorAt(I);
+    }
+
+  private:
+    static FlatCtrl H2(size_type hash) NOEXCEPT {
+      return FlatCtrl(hash & 0x7F);
+    }
+
+    static size_type CapacityFor(size_type n) NOEXCEPT {
+      size_type cap = bit_ceil(n + n / 7 + 1);
+      while(flat_max_load(cap) < n)
+        cap *= 2;
+      return (cap < flat_min_capacity) ? flat_min_capacity : cap;
+    }
+
+    static size_type BlockSize(size_type cap) NOEXCEPT {
+      return cap * sizeof(SlotType) + cap + flat_group_width - 1;
+    }
+
+    template <typename K2>
+    size_type findIndex(const K2& key) const {
+      if(EFL_UNLIKELY(size_ == 0)) 
+        return npos;
+      return this->findIndex(key, hash_(key));
+    }
+
+    template <typename K2>
+    size_type findIndex(const K2& key, size_type hash) const {
+      if(EFL_UNLIKELY(capacity_ == 0)) 
+        return npos;
+      const FlatCtrl h2 = FlatTable::H2(hash);
+      FlatProbe seq(hash >> 7, capacity_ - 1);
+      while(true) {
+        const FlatGroup group(ctrl_ + seq.offset());
+        for(u32 mask = group.match(h2); mask; mask &= mask - 1) {
+          const size_type I = seq.offset(countr_zero(mask));
+          if(EFL_LIKELY(eq_(Policy::Key(slots_[I]), key)))
+            return I;
+        }
+        if(EFL_LIKELY(group.matchEmpty()))
+          return npos;
+        seq.next();
+        EFLI_DBGASSERT_(seq.index_ < capacity_);
+      }
+    }
+
+    /// First empty or deleted slot on the probe sequence.
+    size_type findFirstNonFull(size_type hash) const NOEXCEPT {
+      FlatProbe seq(hash >> 7, capacity_ - 1);
+      while(true) {
+        const FlatGroup group(ctrl_ + seq.offset());
+        if(const u32 mask = group.matchEmptyOrDeleted())
+          return seq.offset(countr_zero(mask));
+        seq.next();
+        EFLI_DBGASSERT_(seq.index_ < capacity_);
+      }
+    }
+
+    size_type prepareInsert(size_type hash) {
+      if(EFL_UNLIKELY(growthLeft_ == 0))
+        this->rehashForInsert();
+      const size_type I = this->findFirstNonFull(hash);
+      // Reusing a tombstone doesn't use up any growth.
+      if(ctrl_[I] == flat_empty)
+        --this->growthLeft_;
+      this->setCtrl(I, FlatTable::H2(hash));
+      ++this->size_;
+      return I;
+    }
+
+    void setCtrl(size_type I, FlatCtrl h) NOEXCEPT {
+      this->ctrl_[I] = h;
+      // Keep the clones in sync.
+      if(I < flat_group_width - 1)
+        this->ctrl_[capacity_ + I] = h;
+    }
+
+    EFL_COLD_PATH void rehashForInsert() {
+      if(capacity_ == 0)
+        return this->resize(flat_min_capacity);
+      // Mostly tombstones, clean up without growing.
+      if(size_ * 32 <= capacity_ * 25)
+        return this->resize(capacity_);
+      this->resize(capacity_ * 2);
+    }
+
+    template <typename K2>
+    size_type eraseKey(const K2& key) {
+      const size_type I = this->findIndex(key);
+      if(I == npos) 
+        return 0;
+      this->eraseAt(I);
+      return 1;
+    }
+
+    void eraseAt(size_type I) {
+      EFLI_DBGASSERT_(I < capacity_ && ctrl_[I] >= 0);
+      X11::destruct(slots_ + I);
+      --this->size_;
+      // If no probe window containing `I` was ever full, no
+      // lookup could have passed over it, so it can be emptied.
+      const size_type before = (I - flat_group_width) & (capacity_ - 1);
+      const u32 empty_after = FlatGroup(ctrl_ + I).matchEmpty();
+      const u32 empty_before = FlatGroup(ctrl_ + before).matchEmpty();
+      const bool was_never_full = empty_before && empty_after &&
+        size_type(countr_zero(u16(empty_after)) + 
+          countl_zero(u16(empty_before))) < flat_group_width;
+      this->setCtrl(I, was_never_full ? flat_empty : flat_deleted);
+      this->growthLeft_ += was_never_full;
+    }
+
+    void resize(size_type new_cap) {
+      FlatCtrl* old_ctrl = ctrl_;
+      SlotType* old_slots = slots_;
+      const size_type old_cap = capacity_;
+
+      ubyte* block = Alloc::allocate(FlatTable::BlockSize(new_cap));
+      $raw_assert(block != nullptr);
+      this->slots_ = reinterpret_cast<SlotType*>(block);
+      this->ctrl_ = reinterpret_cast<FlatCtrl*>(
+        block + new_cap * sizeof(SlotType));
+      this->capacity_ = new_cap;
+      std::memset(ctrl_, flat_empty, new_cap + flat_group_width - 1);
+      this->growthLeft_ = flat_max_load(new_cap) - size_;
+
+      for(size_type I = 0; I < old_cap; ++I) {
+        if(old_ctrl[I] < 0) continue;
+        const size_type hash = hash_(Policy::Key(old_slots[I]));
+        const size_type J = this->findFirstNonFull(hash);
+        this->setCtrl(J, FlatTable::H2(hash));
+        H::relocate_n(old_slots + I, 1, slots_ + J);
+      }
+
+      if(old_cap)
+        Alloc::deallocate(reinterpret_cast<ubyte*>(old_slots), 
+          FlatTable::BlockSize(old_cap));
+    }
+
+    void destroyAll() NOEXCEPT {
+      for(size_type I = 0; I < capacity_; ++I) {
+        if(ctrl_[I] >= 0)
+          X11::destruct(slots_ + I);
+      }
+    }
+
+    void release() NOEXCEPT {
+      if(!capacity_) return;
+      this->destroyAll();
+      Alloc::deallocate(reinterpret_cast<ubyte*>(slots_), 
+        FlatTable::BlockSize(capacity_));
+      this->ctrl_ = const_cast<FlatCtrl*>(flat_empty_group());
+      this->slots_ = nullptr;
+      this->size_ = 0;
+      this->capacity_ = 0;
+      this->growthLeft_ = 0;
+    }
+
+    void copyFrom(const FlatTable& rhs) {
+      this->reserve(rhs.size_);
+      for(size_type I = 0; I < rhs.capacity_; ++I) {
+        if(rhs.ctrl_[I] < 0) continue;
+        const SlotType& slot = rhs.slots_[I];
+        const size_type hash = hash_(Policy::Key(slot));
+        const size_type J = this->prepareInsert(hash);
+        (void) X11::construct(slots_ + J, slot);
+      }
+    }
+
+    void steal(FlatTable& rhs) NOEXCEPT {
+      this->ctrl_ = rhs.ctrl_;
+      this->slots_ = rhs.slots_;
+      this->size_ = rhs.size_;
+      this->capacity_ = rhs.capacity_;
+      this->growthLeft_ = rhs.growthLeft_;
+      rhs.ctrl_ = const_cast<FlatCtrl*>(flat_empty_group());
+      rhs.slots_ = nullptr;
+      rhs.size_ = 0;
+      rhs.capacity_ = 0;
+      rhs.growthLeft_ = 0;
+    }
+
+  private:
+    FlatCtrl* ctrl_ = const_cast<FlatCtrl*>(flat_empty_group());
+    SlotType* slots_ = nullptr;
+    size_type size_ = 0;
+    size_type capacity_ = 0;
+    size_type growthLeft_ = 0;
+    HashFn hash_ { };
+    EqFn eq_ { };
+  };
+} // namespace H
+
+//=== Hash/Equality ===//
+
+/// Default hasher for flat tables.
+/// Strings are hashed as `StrRef`, allowing heterogeneous lookup.
+template <typename K, typename = void>
+struct FlatHash : Hash<K> {
+  using Hash<K>::Hash;
+};
+
+template <typename A>
+struct FlatHash<BasicStr<char, A>> : Hash<StrRef> {
+  using is_transparent = void;
+  using Hash<StrRef>::Hash;
+};
+
+template <>
+struct FlatHash<StrRef> : Hash<StrRef> {
+  using is_transparent = void;
+  using Hash<StrRef>::Hash;
+};
+
+/// Default key equality for flat tables.
+template <typename K, typename = void>
+struct FlatEq {
+  ALWAYS_INLINE bool operator()(const K& l, const K& r) const {
+    return l == r;
+  }
+};
+
+template <typename A>
+struct FlatEq<BasicStr<char, A>> {
+  using is_transparent = void;
+  ALWAYS_INLINE bool operator()(StrRef l, StrRef r) const {
+    return l.isEqual(r);
+  }
+};
+
+template <>
+struct FlatEq<StrRef> : FlatEq<Str> { };
+
+//=== FlatMap ===//
+
+/**
+ * @brief Open addressing hash map, stores pairs inline.
+ * 
+ * Iterators and references are invalidated by any insertion
+ * that rehashes. Keys must not be modified through iterators.
+ */
+template <typename K, typename V, 
+  typename HashFn = FlatHash<K>, typename EqFn = FlatEq<K>>
+struct FlatMap 
+ : H::FlatTable<H::FlatMapPolicy<K, V>, HashFn, EqFn> {
+  using BaseType = H::FlatTable<H::FlatMapPolicy<K, V>, HashFn, EqFn>;
+  using key_type = K;
+  using mapped_type = V;
+  using typename BaseType::size_type;
+  using typename BaseType::iterator;
+  using typename BaseType::const_iterator;
+  using InsertResult = std::pair<iterator, bool>;
+public:
+  using BaseType::BaseType;
+  FlatMap() = default;
+
+  FlatMap(H::InitList<std::pair<K, V>> il) : BaseType(il.size()) {
+    for(const auto& kv : il)
+      this->insert(kv);
+  }
+
+  /// Inserts `kv` if the key doesn't exist.
+  InsertResult insert(const std::pair<K, V>& kv) {
+    return this->tryEmplace(kv.first, kv.second);
+  }
+
+  InsertResult insert(std::pair<K, V>&& kv) {
+    return this->tryEmplace(H::cxpr_move(kv.first), 
+      H::cxpr_move(kv.second));
+  }
+
+  /// Constructs the value from `args` if `key` doesn't exist.
+  /// Nothing is moved from when the key exists.
+  template <typename KK, typename...Args>
+  InsertResult tryEmplace(KK&& key, Args&&...args) {
+    auto res = this->findOrPrepareInsert(key);
+    if(res.inserted)
+      H::FlatMapPolicy<K, V>::Construct(this->slotAt(res.index),
+        FWD_CAST(key), FWD_CAST(args)...);
+    return { this->iteratorAt(res.index), res.inserted };
+  }
+
+  template <typename KK, typename...Args>
+  InsertResult emplace(KK&& key, Args&&...args) {
+    return this->tryEmplace(FWD_CAST(key), FWD_CAST(args)...);
+  }
+
+  /// Inserts `value`, or assigns it if `key` exists.
+  template <typename KK, typename VV>
+  InsertResult insertOrAssign(KK&& key, VV&& value) {
+    auto res = this->findOrPrepareInsert(key);
+    if(res.inserted)
+      H::FlatMapPolicy<K, V>::Construct(this->slotAt(res.index),
+        FWD_CAST(key), FWD_CAST(value));
+    else
+      this->slotAt(res.index)->second = FWD_CAST(value);
+    return { this->iteratorAt(res.index), res.inserted };
+  }
+
+  /// Returns the value at `key`, default constructs if missing.
+  V& operator[](const K& key) {
+    return this->tryEmplace(key).first->second;
+  }
+
+  V& operator[](K&& key) {
+    return this->tryEmplace(H::cxpr_move(key)).first->second;
+  }
+
+  template <typename K2, MEflEnableIf(
+    H::IsFlatTransparent<HashFn, EqFn>::value &&
+    !std::is_same<decay_t<K2>, K>::value)>
+  V& operator[](K2&& key) {
+    return this->tryEmplace(FWD_CAST(key)).first->second;
+  }
+};
+
+//=== FlatSet ===//
+
+/// Open addressing hash set, see `FlatMap`.
+template <typename K, 
+  typename HashFn = FlatHash<K>, typename EqFn = FlatEq<K>>
+struct FlatSet 
+ : H::FlatTable<H::FlatSetPolicy<K>, HashFn, EqFn> {
+  using BaseType = H::FlatTable<H::FlatSetPolicy<K>, HashFn, EqFn>;
+  using key_type = K;
+  using typename BaseType::size_type;
+  using typename BaseType::iterator;
+  using typename BaseType::const_iterator;
+  using InsertResult = std::pair<iterator, bool>;
+public:
+  using BaseType::BaseType;
+  FlatSet() = default;
+
+  FlatSet(H::InitList<K> il) : BaseType(il.size()) {
+    for(const K& key : il)
+      this->insert(key);
+  }
+
+  /// Inserts `key` if it doesn't exist.
+  template <typename KK>
+  InsertResult insert(KK&& key) {
+    auto res = this->findOrPrepareInsert(key);
+    if(res.inserted)
+      H::FlatSetPolicy<K>::Construct(
+        this->slotAt(res.index), FWD_CAST(key));
+    return { this->iteratorAt(res.index), res.inserted };
+  }
+
+  template <typename KK>
+  InsertResult emplace(KK&& key) {
+    return this->insert(FWD_CAST(key));
+  }
+};
+
+} // namespace C
+} // namespace efl
+
+#undef EFLI_FLATMAP_SSE2_
+
+#endif // EFL_CORE_FLATMAP_HPP
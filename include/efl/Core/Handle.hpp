@@ -0,0 +1,257 @@
+//===- Core/Handle.hpp ----------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines Handle and HandlePool, a slot map which
+//  hands out generational indices to densely stored values.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_HANDLE_HPP
+#define EFL_CORE_HANDLE_HPP
+
+#include "Hash.hpp"
+#include "RelocVec.hpp"
+
+namespace efl {
+namespace C {
+
+/**
+ * @brief Generational index into a `HandlePool<T>`.
+ * 
+ * The generation is bumped whenever a slot is freed, so a
+ * handle outlives its value safely: lookups just fail. The
+ * default handle is null, and never matches a live value.
+ */
+template <typename T>
+struct Handle {
+  constexpr Handle() = default;
+  constexpr Handle(u32 index, u32 gen) NOEXCEPT
+   : index_(index), gen_(gen) { }
+
+  /// The slot of the handle in its pool.
+  FICONSTEXPR u32 index() const NOEXCEPT { return index_; }
+  /// The generation of the slot when the handle was made.
+  FICONSTEXPR u32 generation() const NOEXCEPT { return gen_; }
+  /// Checks if the handle was default constructed.
+  FICONSTEXPR bool isNull() const NOEXCEPT { return gen_ == 0; }
+
+  friend constexpr bool operator==(Handle l, Handle r) NOEXCEPT {
+    return (l.index_ == r.index_) && (l.gen_ == r.gen_);
+  }
+
+#if CPPVER_MOST(17)
+  friend constexpr bool operator!=(Handle l, Handle r) NOEXCEPT {
+    return !(l == r);
+  }
+#endif // Three-way Comparison Check (C++20)
+
+public:
+  u32 index_ = 0;
+  u32 gen_ = 0;
+};
+
+template <typename T>
+struct Hash<Handle<T>> : H::HashBase {
+  using H::HashBase::HashBase;
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ usize 
+   operator()(Handle<T> h) const NOEXCEPT {
+    return usize(H::hash_int(
+      (u64(h.gen_) << 32) | h.index_, seed_));
+  }
+};
+
+/**
+ * @name HandlePool
+ * @brief Slot map with stable handles and dense storage.
+ * 
+ * Values are packed in one array, so iteration is a linear
+ * scan. Each slot maps a handle to its dense position; erasing
+ * moves the last value into the hole and recycles the slot
+ * through a free list. Insert, erase and lookup are O(1).
+ */
+template <typename T>
+struct HandlePool {
+  using Type = T;
+  using HandleType = Handle<T>;
+  using value_type = T;
+  using size_type = H::SzType;
+  using iterator = T*;
+  using const_iterator = const T*;
+  static constexpr u32 npos = ~u32(0);
+public:
+  HandlePool() = default;
+
+  //=== Iterators ===//
+
+  iterator begin() NOEXCEPT { return values_.begin(); }
+  iterator end() NOEXCEPT { return values_.end(); }
+  const_iterator begin() const NOEXCEPT { return values_.begin(); }
+  const_iterator end() const NOEXCEPT { return values_.end(); }
+
+  /// Calls `fn(HandleType, T&)` for every value, in dense order.
+  template <typename F>
+  void forEach(F&& fn) {
+    for(size_type I = 0; I < values_.size(); ++I)
+      fn(this->handleAt(I), values_[I]);
+  }
+
+  //=== Element Access ===//
+
+  /// Checks if `h` refers to a live value.
+  NODISCARD bool contains(HandleType h) const NOEXCEPT {
+    return (h.index_ < slots_.size()) 
+      && (slots_[h.index_].gen_ == h.gen_);
+  }
+
+  /// Returns the value for `h`, or null if it was erased.
+  NODISCARD T* get(HandleType h) NOEXCEPT {
+    if(EFL_UNLIKELY(!this->contains(h)))
+      return nullptr;
+    return &values_[slots_[h.index_].dense_];
+  }
+
+  NODISCARD const T* get(HandleType h) const NOEXCEPT {
+    if(EFL_UNLIKELY(!this->contains(h)))
+      return nullptr;
+    return &values_[slots_[h.index_].dense_];
+  }
+
+  /// Returns the value for `h`, which must be live.
+  NODISCARD T& operator[](HandleType h) NOEXCEPT {
+    EFLI_DBGASSERT_(this->contains(h));
+    return values_[slots_[h.index_].dense_];
+  }
+
+  NODISCARD const T& operator[](HandleType h) const NOEXCEPT {
+    EFLI_DBGASSERT_(this->contains(h));
+    return values_[slots_[h.index_].dense_];
+  }
+
+  /// Returns the handle of the value at dense position `n`.
+  NODISCARD HandleType handleAt(size_type n) const NOEXCEPT {
+    EFLI_DBGASSERT_(n < values_.size());
+    const u32 index = denseToSlot_[n];
+    return HandleType(index, slots_[index].gen_);
+  }
+
+  T* data() NOEXCEPT { return values_.data(); }
+  const T* data() const NOEXCEPT { return values_.data(); }
+
+  //=== Observers ===//
+
+  size_type size() const NOEXCEPT { return values_.size(); }
+  bool isEmpty() const NOEXCEPT { return values_.isEmpty(); }
+  /// The number of slots, live or free.
+  size_type slotCount() const NOEXCEPT { return slots_.size(); }
+
+  //=== Modifiers ===//
+
+  /// Constructs a value in place, and returns its handle.
+  template <typename...Args>
+  HandleType emplace(Args&&...args) {
+    const u32 dense = u32(values_.size());
+    values_.emplace_back(FWD_CAST(args)...);
+    const u32 index = this->acquireSlot();
+    denseToSlot_.push_back(index);
+    Slot& slot = slots_[index];
+    slot.dense_ = dense;
+    return HandleType(index, slot.gen_);
+  }
+
+  HandleType insert(const T& t) {
+    return this->emplace(t);
+  }
+
+  HandleType insert(T&& t) {
+    return this->emplace(H::cxpr_move(t));
+  }
+
+  /// Erases the value for `h`. Returns `false` if it was stale.
+  bool erase(HandleType h) {
+    if(EFL_UNLIKELY(!this->contains(h)))
+      return false;
+    Slot& slot = slots_[h.index_];
+    const u32 dense = slot.dense_;
+    const u32 last = u32(values_.size() - 1);
+    if(dense != last) {
+      values_[dense] = H::cxpr_move(values_[last]);
+      const u32 moved = denseToSlot_[last];
+      denseToSlot_[dense] = moved;
+      slots_[moved].dense_ = dense;
+    }
+    values_.pop_back();
+    denseToSlot_.pop_back();
+    this->releaseSlot(h.index_);
+    return true;
+  }
+
+  /// Erases every value, invalidating all handles.
+  void clear() NOEXCEPT {
+    for(u32 index : denseToSlot_)
+      this->releaseSlot(index);
+    values_.clear();
+    denseToSlot_.clear();
+  }
+
+  void reserve(size_type n) {
+    values_.reserve(n);
+    denseToSlot_.reserve(n);
+    slots_.reserve(n);
+  }
+
+private:
+  /// Maps a handle to its value. Free slots hold the
+  /// next free index in `dense_` instead.
+  struct Slot {
+    u32 dense_;
+    u32 gen_;
+  };
+
+  u32 acquireSlot() {
+    if(freeHead_ != npos) {
+      const u32 index = freeHead_;
+      this->freeHead_ = slots_[index].dense_;
+      return index;
+    }
+    EFLI_DBGASSERT_(slots_.size() < npos);
+    slots_.push_back(Slot { 0, 1 });
+    return u32(slots_.size() - 1);
+  }
+
+  void releaseSlot(u32 index) NOEXCEPT {
+    Slot& slot = slots_[index];
+    // Skip the null generation when wrapping.
+    if(EFL_UNLIKELY(++slot.gen_ == 0))
+      slot.gen_ = 1;
+    slot.dense_ = freeHead_;
+    this->freeHead_ = index;
+  }
+
+private:
+  RelocVec<T> values_;
+  RelocVec<u32> denseToSlot_;
+  RelocVec<Slot> slots_;
+  u32 freeHead_ = npos;
+};
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_HANDLE_HPP
@@ -0,0 +1,338 @@
+//===- Core/Hash.hpp ------------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines Hash<...>, a seedable wyhash based hasher.
+//  Short inputs may be hashed at compile time, long buffers
+//  are read 48 bytes at a time.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_HASH_HPP
+#define EFL_CORE_HASH_HPP
+
+#include <cstring>
+#include "ArrayRef.hpp"
+#include "Endian.hpp"
+#include "StrRef.hpp"
+#include "Tuple.hpp"
+#include "_Fwd/Hash.hpp"
+#include "_Fwd/Option.hpp"
+
+namespace efl {
+namespace C {
+/// Specialize to allow hashing the bytes of `T` directly.
+/// Must only be true when equal objects have equal bytes.
+template <typename T>
+struct IsTriviallyHashable : H::BoolC<
+  std::is_integral<T>::value || 
+  std::is_enum<T>::value ||
+  std::is_pointer<T>::value> { };
+
+namespace H {
+  GLOBAL u64 hash_secret[4] {
+    0x2D358DCCAA6C78A5ULL, 0x8BB84B93962EACC9ULL,
+    0x4B33A62ED433D4A3ULL, 0x4D5A2DA51DE1AA47ULL
+  };
+
+  /// Full 64x64 -> 128 multiply, `A` gets the low bits.
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ void 
+   hash_mum(u64& A, u64& B) NOEXCEPT {
+#if EFLI_HAS_I128_
+    const u128 r = u128(A) * B;
+    A = u64(r);
+    B = u64(r >> 64);
+#else
+    const u64 ha = A >> 32, hb = B >> 32;
+    const u64 la = u32(A), lb = u32(B);
+    const u64 rh = ha * hb, rm0 = ha * lb;
+    const u64 rm1 = hb * la, rl = la * lb;
+    const u64 t = rl + (rm0 << 32);
+    u64 c = u64(t < rl);
+    const u64 lo = t + (rm1 << 32);
+    c += u64(lo < t);
+    A = lo;
+    B = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+  }
+
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ u64 hash_mix(u64 A, u64 B) NOEXCEPT {
+    hash_mum(A, B);
+    return A ^ B;
+  }
+
+  /// Reads bytes one at a time, usable in constant expressions.
+  struct HashCxprReader {
+    FICONSTEXPR static u64 R8(const char* p) NOEXCEPT {
+      return u64(R4(p)) | (u64(R4(p + 4)) << 32);
+    }
+    FICONSTEXPR static u64 R4(const char* p) NOEXCEPT {
+      return u64(ubyte(p[0])) | (u64(ubyte(p[1])) << 8) |
+        (u64(ubyte(p[2])) << 16) | (u64(ubyte(p[3])) << 24);
+    }
+  };
+
+  /// Reads whole words, used for long buffers at runtime.
+  struct HashMemReader {
+    ALWAYS_INLINE static u64 R8(const char* p) NOEXCEPT {
+      if(Endianness::Native != Endianness::Little)
+        return HashCxprReader::R8(p);
+      u64 v;
+      std::memcpy(&v, p, sizeof(v));
+      return v;
+    }
+    ALWAYS_INLINE static u64 R4(const char* p) NOEXCEPT {
+      if(Endianness::Native != Endianness::Little)
+        return HashCxprReader::R4(p);
+      u32 v;
+      std::memcpy(&v, p, sizeof(v));
+      return v;
+    }
+  };
+
+  FICONSTEXPR u64 hash_r3(const char* p, SzType k) NOEXCEPT {
+    return (u64(ubyte(p[0])) << 16) | 
+      (u64(ubyte(p[k >> 1])) << 8) | u64(ubyte(p[k - 1]));
+  }
+
+  /// wyhash (final4), with the reads abstracted.
+  template <typename R>
+  EFLI_CXX14_CXPR_ u64 wyhash(
+   const char* p, SzType len, u64 seed) NOEXCEPT {
+    const u64* s = hash_secret;
+    seed ^= hash_mix(seed ^ s[0], s[1]);
+    u64 A = 0, B = 0;
+    if(EFL_LIKELY(len <= 16)) {
+      if(len >= 4) {
+        const SzType off = (len >> 3) << 2;
+        A = (R::R4(p) << 32) | R::R4(p + off);
+        B = (R::R4(p + len - 4) << 32) | R::R4(p + len - 4 - off);
+      } else if(len > 0) {
+        A = hash_r3(p, len);
+      }
+    } else {
+      SzType I = len;
+      if(EFL_UNLIKELY(I > 48)) {
+        // Three independent lanes for the bulk of the input.
+        u64 see1 = seed, see2 = seed;
+        do {
+          seed = hash_mix(R::R8(p) ^ s[1], R::R8(p + 8) ^ seed);
+          see1 = hash_mix(R::R8(p + 16) ^ s[2], R::R8(p + 24) ^ see1);
+          see2 = hash_mix(R::R8(p + 32) ^ s[3], R::R8(p + 40) ^ see2);
+          p += 48;
+          I -= 48;
+        } while(EFL_LIKELY(I > 48));
+        seed ^= see1 ^ see2;
+      }
+      while(EFL_UNLIKELY(I > 16)) {
+        seed = hash_mix(R::R8(p) ^ s[1], R::R8(p + 8) ^ seed);
+        I -= 16;
+        p += 16;
+      }
+      A = R::R8(p + I - 16);
+      B = R::R8(p + I - 8);
+    }
+    A ^= s[1];
+    B ^= seed;
+    hash_mum(A, B);
+    return hash_mix(A ^ s[0] ^ u64(len), B ^ s[1]);
+  }
+
+  /// Hashes `len` bytes. Constant evaluation is supported for
+  /// inputs up to 16 bytes, and for any length where the
+  /// compiler can detect constant evaluation.
+  EFLI_CXX14_CXPR_ u64 hash_bytes(
+   const char* p, SzType len, u64 seed) NOEXCEPT {
+#if (EFLI_HAS_CXPREVAL_ == 1)
+    if(EFL_RT_CXPREVAL()) {
+      return wyhash<HashCxprReader>(p, len, seed);
+    }
+#else
+    if(len <= 16)
+      return wyhash<HashCxprReader>(p, len, seed);
+#endif
+    return wyhash<HashMemReader>(p, len, seed);
+  }
+
+  ALWAYS_INLINE u64 hash_bytes(
+   const void* p, SzType len, u64 seed) NOEXCEPT {
+    return wyhash<HashMemReader>(
+      static_cast<const char*>(p), len, seed);
+  }
+
+  /// Hashes a single word, see `wyhash64`.
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ u64 
+   hash_u64(u64 v, u64 seed) NOEXCEPT {
+    return hash_mix(
+      hash_mix(v ^ hash_secret[0], seed ^ hash_secret[1]), 
+      hash_secret[2]);
+  }
+
+  /// Mixes the hash `h` into `seed`, order dependent.
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ u64 
+   hash_combine(u64 seed, u64 h) NOEXCEPT {
+    return hash_mix(seed ^ hash_secret[2], h ^ hash_secret[3]);
+  }
+
+  template <typename T, MEflEnableIf(sizeof(T) <= sizeof(u64))>
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ u64 
+   hash_int(T t, u64 seed) NOEXCEPT {
+    return hash_u64(u64(t), seed);
+  }
+
+  template <typename T, MEflEnableIf(sizeof(T) > sizeof(u64))>
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ u64 
+   hash_int(T t, u64 seed) NOEXCEPT {
+    return hash_combine(hash_u64(u64(t), seed), 
+      hash_u64(u64(t >> 64), seed));
+  }
+
+  /// Holds the seed for every `Hash<...>`.
+  struct HashBase {
+    constexpr HashBase() = default;
+    explicit constexpr HashBase(u64 seed) : seed_(seed) { }
+    FICONSTEXPR u64 seed() const NOEXCEPT { return seed_; }
+  public:
+    u64 seed_ = 0;
+  };
+} // namespace H
+
+//=== Fundamental ===//
+
+template <typename T>
+struct Hash<T, enable_if_t<
+  std::is_integral<T>::value>> : H::HashBase {
+  using H::HashBase::HashBase;
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ usize 
+   operator()(T t) const NOEXCEPT {
+    return usize(H::hash_int(t, seed_));
+  }
+};
+
+template <typename T>
+struct Hash<T, enable_if_t<
+  std::is_enum<T>::value>> : H::HashBase {
+  using H::HashBase::HashBase;
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ usize 
+   operator()(T t) const NOEXCEPT {
+    using Int = typename std::underlying_type<T>::type;
+    return usize(H::hash_int(Int(t), seed_));
+  }
+};
+
+template <typename T>
+struct Hash<T*> : H::HashBase {
+  using H::HashBase::HashBase;
+  ALWAYS_INLINE usize operator()(const T* p) const NOEXCEPT {
+    return usize(H::hash_u64(u64(std::uintptr_t(p)), seed_));
+  }
+};
+
+//=== Strings ===//
+
+template <>
+struct Hash<StrRef> : H::HashBase {
+  using H::HashBase::HashBase;
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ usize 
+   operator()(StrRef str) const NOEXCEPT {
+    return usize(H::hash_bytes(str.data_, str.size_, seed_));
+  }
+};
+
+/// Hashes `char` strings the same as `StrRef`.
+template <typename Ch, typename A>
+struct Hash<BasicStr<Ch, A>> : H::HashBase {
+  using H::HashBase::HashBase;
+  HINT_INLINE usize operator()(
+   const BasicStr<Ch, A>& str) const NOEXCEPT {
+    return usize(H::hash_bytes(
+      static_cast<const void*>(str.data()), 
+      str.size() * sizeof(Ch), seed_));
+  }
+};
+
+//=== Arrays ===//
+
+/// Hashes the bytes of the elements, so arrays of `char` are
+/// hashed the same as `StrRef`.
+template <typename T>
+struct Hash<ArrayRef<T>, enable_if_t<
+  IsTriviallyHashable<remove_const_t<T>>::value>> : H::HashBase {
+  using H::HashBase::HashBase;
+  HINT_INLINE usize operator()(ArrayRef<T> arr) const NOEXCEPT {
+    return usize(H::hash_bytes(
+      static_cast<const void*>(arr.data()), 
+      arr.sizeInBytes(), seed_));
+  }
+};
+
+template <typename T>
+struct Hash<ImmutArrayRef<T>, enable_if_t<
+  IsTriviallyHashable<T>::value>> : Hash<ArrayRef<const T>> {
+  using Hash<ArrayRef<const T>>::Hash;
+};
+
+//=== Option ===//
+
+template <typename T>
+struct Hash<Option<T>> : H::HashBase {
+  using ElemType = decay_t<T>;
+  using H::HashBase::HashBase;
+  EFLI_CXX14_CXPR_ usize operator()(const Option<T>& O) const {
+    if(!O.hasValue())
+      return usize(H::hash_u64(0, seed_));
+    const u64 h = Hash<ElemType>(seed_)(O.unwrap());
+    return usize(H::hash_combine(seed_, h));
+  }
+};
+
+//=== Tuple ===//
+
+template <typename...TT>
+struct Hash<Tuple<TT...>> : H::HashBase {
+  using H::HashBase::HashBase;
+  EFLI_CXX14_CXPR_ usize operator()(const Tuple<TT...>& tup) const {
+    return this->hashAll(tup, H::MkIdSeq<sizeof...(TT)>{});
+  }
+private:
+  template <H::IdType...II>
+  EFLI_CXX14_CXPR_ usize hashAll(
+   const Tuple<TT...>& tup, H::IdSeq<II...>) const {
+    // The leading zero keeps the array non-empty.
+    const u64 hashes[] { 0, u64(Hash<decay_t<TT>>(seed_)(
+      C::get<II>(tup)))... };
+    u64 h = seed_;
+    for(u64 elem : hashes)
+      h = H::hash_combine(h, elem);
+    return usize(h);
+  }
+};
+
+//=== Helpers ===//
+
+/// Hashes `t` with `Hash<T>`, seeded by `seed`.
+template <typename T>
+FICONSTEXPR usize hash_value(const T& t, u64 seed = 0) {
+  return Hash<T>(seed)(t);
+}
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_HASH_HPP
@@ -37,6 +37,18 @@
 # define EFLI_MI_CXPR_ ALWAYS_INLINE
 #endif
 
+#ifndef EFL_CORE_HEAPCHECK
+/// Set to 0 to remove the debug heap checks from `deallocate`.
+# define EFL_CORE_HEAPCHECK 1
+#endif
+
+#if EFL_CORE_HEAPCHECK
+# define EFLI_HEAPCHECK_(ptr) \
+  EFLI_DBGASSERT_(::efl::C::H::MimAllocatorBase::IsInHeapRegion(ptr))
+#else
+# define EFLI_HEAPCHECK_(ptr) (void)(0)
+#endif
+
 // TODO: Benchmark mimalloc perf on 32bit.
 // See https://github.com/microsoft/mimalloc/issues/825.
 
@@ -75,6 +87,40 @@ ALWAYS_INLINE EFLI_CXX20_CXPR_ auto to_typed_alloc_result(
     static_cast<SizeType>(alloc.count) };
 }
 
+/// Tag for constructing containers from zeroed memory.
+struct zeroed_t {
+  explicit zeroed_t() = default;
+};
+
+GLOBAL zeroed_t zeroed { };
+
+namespace H {
+  template <typename A, typename = void>
+  struct HasAllocateAtLeast : FalseType { };
+
+  template <typename A>
+  struct HasAllocateAtLeast<A, void_t<decltype(
+    Decl<A&>().allocate_at_least(SzType(0)))>>
+   : TrueType { };
+} // namespace H
+
+/// Invokes `alloc.allocate_at_least(n)` if it exists,
+/// otherwise falls back to `alloc.allocate(n)`.
+template <typename A, MEflEnableIf(
+  H::HasAllocateAtLeast<A>::value)>
+ALWAYS_INLINE auto allocate_at_least(A& alloc, H::SzType n)
+ -> AllocationResult<typename A::value_type*, H::SzType> {
+  auto res = alloc.allocate_at_least(n);
+  return { res.ptr, H::SzType(res.count) };
+}
+
+template <typename A, MEflEnableIf(
+  !H::HasAllocateAtLeast<A>::value)>
+ALWAYS_INLINE auto allocate_at_least(A& alloc, H::SzType n)
+ -> AllocationResult<typename A::value_type*, H::SzType> {
+  return { alloc.allocate(n), n };
+}
+
 namespace H {
   GLOBAL SzType mi_small_count = 128;
   GLOBAL SzType mi_align_minimum = (sizeof(void*) == 8) ? 8 : 4;
@@ -97,9 +143,23 @@ namespace H {
     NODISCARD static void* Allocate(SzType size, void* hint);
     NODISCARD static void* AllocateSmall(SzType size);
     NODISCARD static void* AllocateAligned(SzType align, SzType size);
+    NODISCARD static void* AllocateZeroed(SzType size);
+    NODISCARD static void* AllocateZeroedAligned(SzType align, SzType size);
     NODISCARD static VoidAllocResult AllocateAtLeast(SzType size);
+    NODISCARD static VoidAllocResult 
+     AllocateAtLeastAligned(SzType align, SzType size);
     static void Deallocate(void* p); 
+    static void DeallocateSized(void* p, SzType size);
+    static void DeallocateAligned(void* p, SzType align, SzType size);
   public:
+    /// Queues `p` to be returned to its owning thread in bulk.
+    /// Frees immediately if the owner has never collected.
+    static void DeallocateDeferred(void* p);
+    /// Hands the blocks queued on this thread to their owners.
+    static void FlushDeferred();
+    /// Frees the blocks other threads returned to this one.
+    /// @return The number of blocks freed.
+    static SzType CollectDeferred();
     static bool IsMallocRedirected();
     static bool IsInHeapRegion(const void* p);
   };
@@ -126,7 +186,7 @@ namespace H {
   }
 
   template <typename T, SzType Align = alignof(T),
-    bool NotOveraligned = (alignof(T) <= mi_align_minimum)>
+    bool NotOveraligned = (Align <= mi_align_minimum)>
   struct MSVC_EMPTY_BASES 
    AlignedMimAllocatorBase : MimAllocatorBase {
     static_assert(is_power_of_2(Align), 
@@ -135,11 +195,26 @@ namespace H {
     NODISCARD EFLI_MI_CXPR_ static void*
      SmartAllocate(SzType n) NOEXCEPT {
       const auto size = sizeof(T) * n;
-      if(is_small_alloc<T>(n)) 
+      if(is_small_alloc<T>(size)) 
         return MimAllocatorBase::AllocateSmall(size);
       else 
         return MimAllocatorBase::Allocate(size);
     }
+
+    NODISCARD ALWAYS_INLINE static VoidAllocResult
+     SmartAllocateAtLeast(SzType n) NOEXCEPT {
+      return MimAllocatorBase::AllocateAtLeast(sizeof(T) * n);
+    }
+
+    NODISCARD ALWAYS_INLINE static void*
+     SmartAllocateZeroed(SzType n) NOEXCEPT {
+      return MimAllocatorBase::AllocateZeroed(sizeof(T) * n);
+    }
+
+    ALWAYS_INLINE static void 
+     SmartDeallocate(void* p, SzType n) NOEXCEPT {
+      MimAllocatorBase::DeallocateSized(p, sizeof(T) * n);
+    }
   };
 
   template <typename T, SzType Align>
@@ -153,6 +228,24 @@ namespace H {
       const auto size = sizeof(T) * n;
       return MimAllocatorBase::AllocateAligned(Align, size);
     }
+
+    NODISCARD ALWAYS_INLINE static VoidAllocResult
+     SmartAllocateAtLeast(SzType n) NOEXCEPT {
+      const auto size = sizeof(T) * n;
+      return MimAllocatorBase::AllocateAtLeastAligned(Align, size);
+    }
+
+    NODISCARD ALWAYS_INLINE static void*
+     SmartAllocateZeroed(SzType n) NOEXCEPT {
+      const auto size = sizeof(T) * n;
+      return MimAllocatorBase::AllocateZeroedAligned(Align, size);
+    }
+
+    ALWAYS_INLINE static void 
+     SmartDeallocate(void* p, SzType n) NOEXCEPT {
+      const auto size = sizeof(T) * n;
+      MimAllocatorBase::DeallocateAligned(p, Align, size);
+    }
   };
 } // namespace H
 
@@ -172,13 +265,15 @@ public:
   using reference = T&;
   using const_reference = const T&;
   using is_always_equal = H::TrueType;
+#endif // Member Check (C++20)
 
-  template <typename U, 
-    H::SzType UAlign = alignof(U)>
+  /// Required, `Align` stops `allocator_traits` from deducing this.
+  /// Keeps the alignment when rebinding, so `rebind<T>` is identity.
+  template <typename U, H::SzType UAlign = 
+    ((alignof(U) > Align) ? alignof(U) : Align)>
   struct rebind {
     using other = MimAllocator<U, UAlign>;
   };
-#endif // Member Check (C++20)
 
   using size_type = H::SzType;
   using difference_type = std::ptrdiff_t;
@@ -187,6 +282,8 @@ public:
 public:
   constexpr MimAllocator() NOEXCEPT = default;
   constexpr MimAllocator(const MimAllocator&) NOEXCEPT = default;
+  template <typename U, H::SzType UAlign>
+  constexpr MimAllocator(const MimAllocator<U, UAlign>&) NOEXCEPT { }
   EFLI_CXX20_CXPR_ ~MimAllocator() = default;
 
   //=== Member Functions ===//
@@ -213,7 +310,28 @@ public:
     return SmartAllocate(n);
   }
 
-  EFLI_MI_CXPR_ static void deallocate(T* ptr, MAYBE_UNUSED size_type n) {
+  /// Allocates storage for `n` objects, with every byte zeroed.
+  /// Fresh pages from the OS are not cleared a second time.
+  NODISCARD static T* allocate_zeroed(size_type n) {
+    return static_cast<T*>(
+      SmartAllocator::SmartAllocateZeroed(n));
+  }
+
+  /// Allocates storage for at least `n` objects. 
+  /// The returned count includes the slack in the size class.
+  NODISCARD EFLI_MI_CXPR_ static AllocationResult<T*, size_type> 
+   allocate_at_least(size_type n) {
+#if (EFLI_HAS_CXPREVAL_ == 1)
+    if(EFL_RT_CXPREVAL()) UNLIKELY {
+      return { MimAllocator::allocate(n), n };
+    }
+#endif
+    auto res = SmartAllocator::SmartAllocateAtLeast(n);
+    return { static_cast<T*>(res.ptr), 
+      size_type(res.count / sizeof(T)) };
+  }
+
+  EFLI_MI_CXPR_ static void deallocate(T* ptr, size_type n) {
 #if (EFLI_HAS_CXPREVAL_ == 1)
     if(EFL_RT_CXPREVAL()) UNLIKELY {
       ::operator delete(ptr);
@@ -221,8 +339,15 @@ public:
     }
 #endif
     // Ensure pointer was allocated by us.
-    EFLI_DBGASSERT_(H::MimAllocatorBase::IsInHeapRegion(ptr));
-    return H::MimAllocatorBase::Deallocate(ptr);
+    EFLI_HEAPCHECK_(ptr);
+    return SmartAllocator::SmartDeallocate(ptr, n);
+  }
+
+  /// Frees `ptr` through the owning thread, see `DeallocateDeferred`.
+  /// Used when the block was allocated on another thread.
+  static void deallocate_deferred(T* ptr, size_type) {
+    EFLI_HEAPCHECK_(ptr);
+    H::MimAllocatorBase::DeallocateDeferred(ptr);
   }
 
 #if CPPVER_MOST(17)
@@ -252,6 +377,18 @@ HINT_INLINE constexpr bool operator!=(
  NOEXCEPT { return false; }
 #endif // Three-way Comparison Check (C++20)
 
+/// Returns the blocks deferred on this thread to their owners.
+/// Called automatically when a thread exits.
+inline void flush_deferred_frees() {
+  H::MimAllocatorBase::FlushDeferred();
+}
+
+/// Frees blocks deferred by other threads. Must be called 
+/// periodically by threads that own deferred blocks.
+inline H::SzType collect_deferred_frees() {
+  return H::MimAllocatorBase::CollectDeferred();
+}
+
 } // namespace C
 } // namespace efl
 
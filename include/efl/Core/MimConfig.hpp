@@ -0,0 +1,158 @@
+//===- Core/MimConfig.hpp -------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines a typed interface for tuning mimalloc, which
+//  can be applied during static initialization.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_MIMCONFIG_HPP
+#define EFL_CORE_MIMCONFIG_HPP
+
+#include "Fundamental.hpp"
+#include "Preload.hpp"
+#include "Traits/Macros.hpp"
+
+#if (defined(COMPILER_GCC) || defined(COMPILER_CLANG)) && \
+ !defined(PLATFORM_WINDOWS)
+# define EFLI_MIMCONFIG_PRIORITY_ __attribute__((init_priority(101)))
+#else
+# define EFLI_MIMCONFIG_PRIORITY_
+#endif
+
+/// Applies the `MimConfig` returned by `Init{}()` at static init,
+/// before any other static object is constructed where supported.
+/// This should only be used once, in a source file.
+/// On Windows there is no priority, so it runs in declaration
+/// order with the file's other statics. Put it in its own file
+/// with `#pragma init_seg(lib)` if it must run first.
+#define MEflMimConfig(...) \
+  static const ::efl::C::StaticExec< \
+    ::efl::C::H::MimConfigExec<__VA_ARGS__>> \
+   EFLI_UNIQUE_VAR_(_v_mimconfig) EFLI_MIMCONFIG_PRIORITY_
+
+namespace efl {
+namespace C {
+/**
+ * @brief Startup options for mimalloc.
+ * 
+ * Options which are not set keep mimalloc's defaults,
+ * including any set with environment variables.
+ * Set options take priority over the environment.
+ */
+struct MimConfig {
+  /// Reserves `count` 1GiB huge OS pages, interleaved over
+  /// `nodes` NUMA nodes (0 uses all of them).
+  MimConfig& reserveHugePages(usize count, 
+   usize nodes = 0, usize timeout_ms = 0) NOEXCEPT {
+    this->huge_pages_ = count;
+    this->huge_nodes_ = nodes;
+    this->huge_timeout_ = timeout_ms;
+    return *this;
+  }
+
+  /// Reserves an arena of `size` bytes up front.
+  MimConfig& reserveOsMemory(usize size, bool commit = false) NOEXCEPT {
+    this->os_memory_ = size;
+    this->os_commit_ = commit;
+    return *this;
+  }
+
+  /// Allows large (2MiB) OS pages, implies eager commit.
+  MimConfig& largePages(bool enable) NOEXCEPT {
+    return this->set(LargePages, enable);
+  }
+
+  /// Commits segments as soon as they are reserved.
+  MimConfig& eagerCommit(bool enable) NOEXCEPT {
+    return this->set(EagerCommit, enable);
+  }
+
+  /// Delay in milliseconds before freed memory is purged.
+  /// Use 0 to purge immediately, and -1 to never purge.
+  MimConfig& purgeDelay(long ms) NOEXCEPT {
+    return this->set(PurgeDelay, ms);
+  }
+
+  /// The size of arenas mimalloc reserves when it needs more memory.
+  /// This is rounded down to KiB.
+  MimConfig& arenaReserve(usize size) NOEXCEPT {
+    return this->set(ArenaReserve, long(size / 1024));
+  }
+
+  /// Sets the options, then makes any reservations.
+  /// @return `false` if a reservation failed.
+  bool apply() const NOEXCEPT;
+
+  /// Reads the current value of each option.
+  static MimConfig Current() NOEXCEPT;
+
+  bool hasLargePages() const NOEXCEPT 
+  { return this->get(LargePages) != 0; }
+
+  bool hasEagerCommit() const NOEXCEPT 
+  { return this->get(EagerCommit) != 0; }
+
+  long getPurgeDelay() const NOEXCEPT 
+  { return this->get(PurgeDelay); }
+
+  usize getArenaReserve() const NOEXCEPT 
+  { return usize(this->get(ArenaReserve)) * 1024; }
+
+private:
+  enum Option : u8 {
+    LargePages, EagerCommit, 
+    PurgeDelay, ArenaReserve,
+    MaxOption
+  };
+
+  MimConfig& set(Option opt, long value) NOEXCEPT {
+    this->set_mask_ |= u8(1U << opt);
+    this->options_[opt] = value;
+    return *this;
+  }
+
+  long get(Option opt) const NOEXCEPT {
+    return this->options_[opt];
+  }
+
+private:
+  usize huge_pages_ = 0;
+  usize huge_nodes_ = 0;
+  usize huge_timeout_ = 0;
+  usize os_memory_ = 0;
+  bool os_commit_ = false;
+  u8 set_mask_ = 0;
+  long options_[MaxOption] { };
+};
+
+namespace H {
+  template <typename Init>
+  struct MimConfigExec {
+    void operator()() const NOEXCEPT {
+      const MimConfig config = Init{}();
+      (void) config.apply();
+    }
+  };
+} // namespace H
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_MIMCONFIG_HPP
@@ -0,0 +1,308 @@
+//===- Core/MimHeapAllocator.hpp ------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines an owning handle for mimalloc heaps, and a
+//  stateful allocator which allocates from a specific heap.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_MIMHEAPALLOCATOR_HPP
+#define EFL_CORE_MIMHEAPALLOCATOR_HPP
+
+#include "MimAllocator.hpp"
+#include "Traits/Functions.hpp"
+#include "_Builtins.hpp"
+#include "_Version.hpp"
+
+// Matches `mi_heap_t`, keeps the mimalloc headers hidden.
+struct mi_heap_s;
+
+namespace efl {
+namespace C {
+template <typename T, H::SzType Align>
+struct MimHeapAllocator;
+
+namespace H {
+  /// Opaque handle to a `mi_heap_t`.
+  using MimHeapHandle = ::mi_heap_s*;
+
+  /**
+   * Generic interface for interfacing with mimalloc heaps.
+   * Deallocation is inherited, as `mi_free` works
+   * regardless of the heap a block belongs to.
+   */
+  struct MimHeapBase : MimAllocatorBase {
+  protected:
+    NODISCARD static void* HeapAllocate(
+      MimHeapHandle heap, SzType size);
+    NODISCARD static void* HeapAllocateAligned(
+      MimHeapHandle heap, SzType align, SzType size);
+  public:
+    NODISCARD static MimHeapHandle HeapNew();
+    static void HeapDelete(MimHeapHandle heap);
+    static void HeapDestroy(MimHeapHandle heap);
+    static bool HeapContains(MimHeapHandle heap, const void* p);
+  };
+
+  template <typename T, SzType Align = alignof(T),
+    bool NotOveraligned = (Align <= mi_align_minimum)>
+  struct MSVC_EMPTY_BASES 
+   AlignedMimHeapBase : MimHeapBase {
+    static_assert(is_power_of_2(Align), 
+      "Alignment MUST be a power of 2.");
+  public:
+    NODISCARD ALWAYS_INLINE static void*
+     SmartAllocate(MimHeapHandle heap, SzType n) NOEXCEPT {
+      return MimHeapBase::HeapAllocate(heap, sizeof(T) * n);
+    }
+
+    ALWAYS_INLINE static void 
+     SmartDeallocate(void* p, SzType n) NOEXCEPT {
+      MimAllocatorBase::DeallocateSized(p, sizeof(T) * n);
+    }
+  };
+
+  template <typename T, SzType Align>
+  struct MSVC_EMPTY_BASES 
+   AlignedMimHeapBase<T, Align, false> : MimHeapBase {
+    static_assert(is_power_of_2(Align), 
+      "Alignment MUST be a power of 2.");
+  public:
+    NODISCARD ALWAYS_INLINE static void*
+     SmartAllocate(MimHeapHandle heap, SzType n) NOEXCEPT {
+      return MimHeapBase::HeapAllocateAligned(
+        heap, Align, sizeof(T) * n);
+    }
+
+    ALWAYS_INLINE static void 
+     SmartDeallocate(void* p, SzType n) NOEXCEPT {
+      MimAllocatorBase::DeallocateAligned(p, Align, sizeof(T) * n);
+    }
+  };
+} // namespace H
+
+/**
+ * @brief Owning handle to a mimalloc heap.
+ * 
+ * Heaps are bound to the thread that created them, so
+ * allocations must be made on that thread. Blocks may
+ * be freed from any thread. Calling `destroy()` releases
+ * every block in the heap at once, without visiting them.
+ */
+struct MimHeap {
+  using HandleType = H::MimHeapHandle;
+public:
+  /// Creates a new heap owned by the current thread.
+  MimHeap() : handle_(H::MimHeapBase::HeapNew()) { }
+  MimHeap(const MimHeap&) = delete;
+
+  /// Takes ownership of the heap in `heap`.
+  MimHeap(MimHeap&& heap) NOEXCEPT 
+   : handle_(heap.release()) { }
+
+  /// Takes ownership of a raw heap handle.
+  explicit MimHeap(HandleType handle) NOEXCEPT 
+   : handle_(handle) { }
+
+  MimHeap& operator=(const MimHeap&) = delete;
+
+  /// Deletes the current heap, then takes ownership of `heap`.
+  MimHeap& operator=(MimHeap&& heap) NOEXCEPT {
+    this->reset();
+    this->handle_ = heap.release();
+    return *this;
+  }
+
+  /// Calls `reset()`.
+  ~MimHeap() { this->reset(); }
+
+  //=== Modifiers ===//
+
+  /// Deletes the heap. Blocks which are still alive
+  /// are migrated to the thread's default heap.
+  void reset() NOEXCEPT {
+    if(EFL_SOFT_LIKELY(this->handle_))
+      H::MimHeapBase::HeapDelete(this->handle_);
+    this->handle_ = nullptr;
+  }
+
+  /// Destroys the heap, freeing every block it owns.
+  /// Nothing allocated in the heap may be used 
+  /// (or deallocated) after this is called.
+  void destroy() NOEXCEPT {
+    if(EFL_SOFT_LIKELY(this->handle_))
+      H::MimHeapBase::HeapDestroy(this->handle_);
+    this->handle_ = nullptr;
+  }
+
+  NODISCARD HandleType release() NOEXCEPT {
+    HandleType released_handle = this->handle_;
+    this->handle_ = nullptr;
+    return released_handle;
+  }
+
+  void swap(MimHeap& heap) NOEXCEPT {
+    HandleType old_handle = this->handle_;
+    this->handle_ = heap.handle_;
+    heap.handle_ = old_handle;
+  }
+
+  //=== Observers ===//
+
+  ALWAYS_INLINE HandleType get() const NOEXCEPT
+  { return this->handle_; }
+
+  ALWAYS_INLINE bool isEmpty() const NOEXCEPT
+  { return !this->handle_; }
+
+  explicit operator bool() const NOEXCEPT 
+  { return bool(this->handle_); }
+
+  /// Checks if `p` points to a block owned by the heap.
+  bool contains(const void* p) const {
+    if(EFL_UNLIKELY(!this->handle_)) return false;
+    return H::MimHeapBase::HeapContains(this->handle_, p);
+  }
+
+  /// Creates an allocator bound to the heap.
+  template <typename T, H::SzType Align = alignof(T)>
+  MimHeapAllocator<T, Align> allocator() const NOEXCEPT;
+
+private:
+  HandleType handle_ = nullptr;
+};
+
+/**
+ * @brief Stateful allocator bound to a `MimHeap`.
+ * 
+ * Default constructed allocators use the thread's default heap.
+ * Deallocation is stateless, so the static `Delete` 
+ * can be used with `Box<T, MimHeapAllocator<T>>`.
+ */
+template <typename T, H::SzType Align = alignof(T)>
+struct MSVC_EMPTY_BASES MimHeapAllocator 
+ : H::AlignedMimHeapBase<T, Align> {
+  static_assert(Align >= alignof(T), 
+    "Alignment requirement must be >= alignof(T).");
+  template <typename, H::SzType>
+  friend struct MimHeapAllocator;
+public:
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using SmartAllocator = H::AlignedMimHeapBase<T, Align>;
+  using HandleType = H::MimHeapHandle;
+  using propagate_on_container_copy_assignment = H::TrueType;
+  using propagate_on_container_move_assignment = H::TrueType;
+  using propagate_on_container_swap = H::TrueType;
+  using is_always_equal = H::FalseType;
+
+  /// Required, `Align` stops `allocator_traits` from deducing this.
+  template <typename U, H::SzType UAlign = 
+    ((alignof(U) > Align) ? alignof(U) : Align)>
+  struct rebind {
+    using other = MimHeapAllocator<U, UAlign>;
+  };
+
+  using size_type = H::SzType;
+  using difference_type = std::ptrdiff_t;
+  static constexpr H::SzType alignment_value = Align;
+
+public:
+  constexpr MimHeapAllocator() NOEXCEPT = default;
+  constexpr MimHeapAllocator(const MimHeapAllocator&) NOEXCEPT = default;
+
+  /// Binds the allocator to `heap`.
+  MimHeapAllocator(const MimHeap& heap) NOEXCEPT 
+   : heap_(heap.get()) { }
+  
+  /// Binds the allocator to a raw heap handle.
+  constexpr explicit MimHeapAllocator(HandleType heap) NOEXCEPT 
+   : heap_(heap) { }
+
+  /// Rebinding constructor.
+  template <typename U, H::SzType UAlign>
+  constexpr MimHeapAllocator(
+    const MimHeapAllocator<U, UAlign>& alloc) NOEXCEPT 
+   : heap_(alloc.heap_) { }
+
+  MimHeapAllocator& operator=(const MimHeapAllocator&) = default;
+
+  //=== Member Functions ===//
+
+  NODISCARD T* allocate(size_type n) const {
+    return static_cast<T*>(
+      SmartAllocator::SmartAllocate(heap_, n));
+  }
+
+  static void deallocate(T* ptr, size_type n) {
+    // Ensure pointer was allocated by mimalloc.
+    EFLI_HEAPCHECK_(ptr);
+    return SmartAllocator::SmartDeallocate(ptr, n);
+  }
+
+  /// Constructs an object in the bound heap.
+  /// Used by `Box<T, MimHeapAllocator<T>>::NewIn(...)`.
+  template <typename...Args>
+  NODISCARD pointer New(Args&&...args) const {
+    pointer data = this->allocate(1);
+    return X11::construct(data, FWD_CAST(args)...);
+  }
+
+  /// Destroys an object, then frees its storage.
+  static void Delete(pointer data) {
+    if(EFL_SOFT_UNLIKELY(!data)) return;
+    X11::destruct(data);
+    MimHeapAllocator::deallocate(data, 1);
+  }
+
+  /// Returns the bound heap, or null for the default heap.
+  ALWAYS_INLINE HandleType heap() const NOEXCEPT
+  { return this->heap_; }
+
+private:
+  HandleType heap_ = nullptr;
+};
+
+template <typename T, H::SzType Align>
+MimHeapAllocator<T, Align> MimHeap::allocator() const NOEXCEPT {
+  return MimHeapAllocator<T, Align>(this->handle_);
+}
+
+template <typename T1, typename T2, H::SzType A1, H::SzType A2>
+HINT_INLINE constexpr bool operator==(
+ const MimHeapAllocator<T1, A1>& t1, 
+ const MimHeapAllocator<T2, A2>& t2) NOEXCEPT { 
+  return t1.heap() == t2.heap();
+}
+
+#if CPPVER_MOST(17)
+template <typename T1, typename T2, H::SzType A1, H::SzType A2>
+HINT_INLINE constexpr bool operator!=(
+ const MimHeapAllocator<T1, A1>& t1, 
+ const MimHeapAllocator<T2, A2>& t2) NOEXCEPT { 
+  return t1.heap() != t2.heap();
+}
+#endif // Three-way Comparison Check (C++20)
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_MIMHEAPALLOCATOR_HPP
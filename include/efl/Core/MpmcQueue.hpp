@@ -0,0 +1,335 @@
+//===- Core/MpmcQueue.hpp -------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines MpmcQueue<...>, a bounded lock-free queue
+//  for any number of producers and consumers, after Dmitry Vyukov's
+//  sequence numbered ring. Blocking operations wait on a futex.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_MPMCQUEUE_HPP
+#define EFL_CORE_MPMCQUEUE_HPP
+
+#include "SpscQueue.hpp"
+
+namespace efl {
+namespace C {
+namespace H {
+  /// Sleeps while `*word == expected`. May wake spuriously.
+  void futex_wait(const std::atomic<u32>* word, u32 expected) NOEXCEPT;
+  /// Wakes one thread waiting on `word`.
+  void futex_wake_one(const std::atomic<u32>* word) NOEXCEPT;
+  /// Wakes every thread waiting on `word`.
+  void futex_wake_all(const std::atomic<u32>* word) NOEXCEPT;
+
+  /**
+   * @brief Lets threads sleep until the other side makes progress.
+   * 
+   * The low bit of the word marks sleepers, the rest is an epoch.
+   * Notifying only costs a syscall when the bit is set, and then
+   * wakes every sleeper, so a burst of pushes wakes each once.
+   */
+  struct QueueSignal {
+    /// Marks the caller as a sleeper, returns the word to wait on.
+    /// The caller must recheck its condition before `wait(...)`.
+    ALWAYS_INLINE u32 prepare() NOEXCEPT {
+      u32 word = word_.load(std::memory_order_relaxed);
+      while(!(word & 1) && !word_.compare_exchange_weak(word, word | 1,
+       std::memory_order_relaxed, std::memory_order_relaxed)) { }
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      return word | 1;
+    }
+
+    /// Sleeps until `notify()` is called after `prepare()`.
+    void wait(u32 word) NOEXCEPT {
+#if EFL_MULTITHREADED
+      H::futex_wait(&word_, word);
+#else
+      // No other thread can ever make progress.
+      (void) word;
+      $raw_assert(false);
+#endif
+    }
+
+    /// Wakes the sleepers, cheap when there are none.
+    /// Must follow the store that published the progress.
+    ALWAYS_INLINE void notify() NOEXCEPT {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(EFL_LIKELY(!(word_.load(std::memory_order_relaxed) & 1)))
+        return;
+      this->wake();
+    }
+
+  private:
+    EFL_COLD_PATH void wake() NOEXCEPT {
+      u32 word = word_.load(std::memory_order_relaxed);
+      // Clears the sleeper bit, and bumps the epoch.
+      while((word & 1) && !word_.compare_exchange_weak(word, word + 1,
+       std::memory_order_relaxed, std::memory_order_relaxed)) { }
+#if EFL_MULTITHREADED
+      if(word & 1)
+        H::futex_wake_all(&word_);
+#endif
+    }
+
+  private:
+    QueueAtomic<u32> word_ { };
+  };
+
+  template <typename T>
+  struct MpmcCell {
+    QueueAtomic<SzType> seq_;
+    alignas(T) ubyte data_[sizeof(T)];
+  };
+} // namespace H
+
+/**
+ * @brief Bounded multi-producer/multi-consumer queue.
+ * 
+ * Each cell carries a sequence number, telling producers and
+ * consumers whose turn it is, so threads only contend on the
+ * head or tail index. The `try*` operations are lock-free and
+ * never block. `push` and `pop` sleep on a futex while the queue
+ * is full or empty, and every operation wakes sleepers.
+ */
+template <typename T>
+struct MpmcQueue {
+  using SelfType = MpmcQueue<T>;
+  using Cell = H::MpmcCell<T>;
+  using Alloc = MimAllocator<Cell, (alignof(Cell) > H::queue_cacheline)
+    ? alignof(Cell) : H::queue_cacheline>;
+  using value_type = T;
+  using size_type = H::SzType;
+public:
+  /// Creates a queue holding at least `capacity` elements.
+  /// The capacity is rounded up to a power of 2.
+  explicit MpmcQueue(size_type capacity)
+   : capacity_(bit_ceil(capacity < 2 ? 2 : capacity)), 
+   cells_(Alloc::allocate(capacity_)) {
+    $raw_assert(cells_ != nullptr);
+    for(size_type I = 0; I < capacity_; ++I)
+      cells_[I].seq_.store(I, std::memory_order_relaxed);
+  }
+
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  /// Destroys anything left in the queue.
+  ~MpmcQueue() {
+    const size_type head = head_.value.load(std::memory_order_relaxed);
+    const size_type tail = tail_.value.load(std::memory_order_relaxed);
+    for(size_type I = head; I != tail; ++I)
+      X11::destruct(MpmcQueue::Data(this->cell(I)));
+    Alloc::deallocate(cells_, capacity_);
+  }
+
+  //=== Producers ===//
+
+  /// Constructs an element at the back, fails if full.
+  template <typename...Args>
+  bool tryEmplace(Args&&...args) {
+    size_type pos = tail_.value.load(std::memory_order_relaxed);
+    Cell* cell;
+    while(true) {
+      cell = this->cell(pos);
+      const size_type seq = cell->seq_.load(std::memory_order_acquire);
+      const auto diff = std::ptrdiff_t(seq - pos);
+      if(diff == 0) {
+        if(tail_.value.compare_exchange_weak(pos, pos + 1,
+         std::memory_order_relaxed, std::memory_order_relaxed))
+          break;
+      } else if(diff < 0) {
+        return false;
+      } else {
+        pos = tail_.value.load(std::memory_order_relaxed);
+      }
+    }
+    (void) X11::construct(MpmcQueue::Data(cell), FWD_CAST(args)...);
+    cell->seq_.store(pos + 1, std::memory_order_release);
+    this->notEmpty_.value.notify();
+    return true;
+  }
+
+  bool tryPush(const T& t) { return this->tryEmplace(t); }
+  bool tryPush(T&& t) { return this->tryEmplace(H::cxpr_move(t)); }
+
+  /// Pushes `t`, sleeping while the queue is full.
+  template <typename U>
+  void push(U&& u) {
+    while(!this->tryEmplace(FWD_CAST(u))) {
+      const u32 word = notFull_.value.prepare();
+      if(this->tryEmplace(FWD_CAST(u)))
+        return;
+      notFull_.value.wait(word);
+    }
+  }
+
+  /// Claims a run of cells at once, and copies in as much
+  /// of `arr` as fits. Returns the number of elements pushed.
+  size_type tryPushBatch(ImmutArrayRef<T> arr) {
+    if(EFL_UNLIKELY(arr.size_ == 0)) 
+      return 0;
+    size_type pos = tail_.value.load(std::memory_order_relaxed);
+    size_type n;
+    while(true) {
+      n = this->readyRun(pos, 0, arr.size_);
+      if(n == 0) {
+        const size_type seq = 
+          this->cell(pos)->seq_.load(std::memory_order_acquire);
+        if(std::ptrdiff_t(seq - pos) < 0)
+          return 0;
+        pos = tail_.value.load(std::memory_order_relaxed);
+        continue;
+      }
+      if(tail_.value.compare_exchange_weak(pos, pos + n,
+       std::memory_order_relaxed, std::memory_order_relaxed))
+        break;
+    }
+    for(size_type I = 0; I < n; ++I) {
+      Cell* cell = this->cell(pos + I);
+      (void) X11::construct(MpmcQueue::Data(cell), arr.data_[I]);
+      cell->seq_.store(pos + I + 1, std::memory_order_release);
+    }
+    this->notEmpty_.value.notify();
+    return n;
+  }
+
+  //=== Consumers ===//
+
+  /// Moves the front element into `out`, fails if empty.
+  bool tryPop(T& out) {
+    size_type pos = head_.value.load(std::memory_order_relaxed);
+    Cell* cell;
+    while(true) {
+      cell = this->cell(pos);
+      const size_type seq = cell->seq_.load(std::memory_order_acquire);
+      const auto diff = std::ptrdiff_t(seq - (pos + 1));
+      if(diff == 0) {
+        if(head_.value.compare_exchange_weak(pos, pos + 1,
+         std::memory_order_relaxed, std::memory_order_relaxed))
+          break;
+      } else if(diff < 0) {
+        return false;
+      } else {
+        pos = head_.value.load(std::memory_order_relaxed);
+      }
+    }
+    this->take(cell, pos, out);
+    this->notFull_.value.notify();
+    return true;
+  }
+
+  /// Pops into `out`, sleeping while the queue is empty.
+  void pop(T& out) {
+    while(!this->tryPop(out)) {
+      const u32 word = notEmpty_.value.prepare();
+      if(this->tryPop(out))
+        return;
+      notEmpty_.value.wait(word);
+    }
+  }
+
+  /// Claims a run of full cells at once, and moves up to
+  /// `out.size()` elements out. Returns the number popped.
+  size_type tryPopBatch(ArrayRef<T> out) {
+    if(EFL_UNLIKELY(out.size_ == 0)) 
+      return 0;
+    size_type pos = head_.value.load(std::memory_order_relaxed);
+    size_type n;
+    while(true) {
+      n = this->readyRun(pos, 1, out.size_);
+      if(n == 0) {
+        const size_type seq = 
+          this->cell(pos)->seq_.load(std::memory_order_acquire);
+        if(std::ptrdiff_t(seq - (pos + 1)) < 0)
+          return 0;
+        pos = head_.value.load(std::memory_order_relaxed);
+        continue;
+      }
+      if(head_.value.compare_exchange_weak(pos, pos + n,
+       std::memory_order_relaxed, std::memory_order_relaxed))
+        break;
+    }
+    for(size_type I = 0; I < n; ++I)
+      this->take(this->cell(pos + I), pos + I, out.data_[I]);
+    this->notFull_.value.notify();
+    return n;
+  }
+
+  //=== Observers ===//
+
+  size_type capacity() const NOEXCEPT { return capacity_; }
+
+  /// The number of elements, may be stale immediately.
+  size_type sizeApprox() const NOEXCEPT {
+    const size_type head = head_.value.load(std::memory_order_acquire);
+    const size_type tail = tail_.value.load(std::memory_order_acquire);
+    return (tail > head) ? tail - head : 0;
+  }
+
+  bool isEmptyApprox() const NOEXCEPT {
+    return this->sizeApprox() == 0;
+  }
+
+private:
+  ALWAYS_INLINE static T* Data(Cell* cell) NOEXCEPT {
+    return reinterpret_cast<T*>(cell->data_);
+  }
+
+  ALWAYS_INLINE Cell* cell(size_type pos) const NOEXCEPT {
+    return cells_ + (pos & (capacity_ - 1));
+  }
+
+  /// Counts the cells from `pos` whose turn it is, up to `max`.
+  /// `lap` is 0 for producers, and 1 for consumers.
+  size_type readyRun(size_type pos, size_type lap, 
+   size_type max) const NOEXCEPT {
+    size_type n = 0;
+    while(n < max) {
+      const size_type seq = 
+        this->cell(pos + n)->seq_.load(std::memory_order_acquire);
+      if(seq != pos + n + lap)
+        break;
+      ++n;
+    }
+    return n;
+  }
+
+  /// Moves out of a claimed cell, and hands it to producers.
+  ALWAYS_INLINE void take(Cell* cell, size_type pos, T& out) {
+    T* p = MpmcQueue::Data(cell);
+    out = H::cxpr_move(*p);
+    X11::destruct(p);
+    cell->seq_.store(pos + capacity_, std::memory_order_release);
+  }
+
+private:
+  const size_type capacity_;
+  Cell* const cells_;
+  H::CachePadded<H::QueueAtomic<size_type>> tail_ { };
+  H::CachePadded<H::QueueAtomic<size_type>> head_ { };
+  H::CachePadded<H::QueueSignal> notEmpty_ { };
+  H::CachePadded<H::QueueSignal> notFull_ { };
+};
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_MPMCQUEUE_HPP
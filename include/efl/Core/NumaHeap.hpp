@@ -0,0 +1,148 @@
+//===- Core/NumaHeap.hpp --------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines mimalloc heaps backed by arenas bound to a
+//  NUMA node. On single node systems they use the default heap.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_NUMAHEAP_HPP
+#define EFL_CORE_NUMAHEAP_HPP
+
+#include "MimHeapAllocator.hpp"
+
+namespace efl {
+namespace C {
+/// The number of NUMA nodes, at least 1.
+/// Capped by mimalloc's `use_numa_nodes` option.
+usize numa_node_count() NOEXCEPT;
+
+/// The NUMA node the current thread is running on.
+int current_numa_node() NOEXCEPT;
+
+/**
+ * @brief Heap which allocates from a single NUMA node.
+ * 
+ * Each node has one exclusive arena, reserved on first use and
+ * kept for the lifetime of the program. Pages are only committed
+ * when touched, and are bound to the node on Linux. 
+ * On single node systems (or if the arena could not be reserved)
+ * the heap degrades to the thread's default heap.
+ * Like `MimHeap`, this must be used on the creating thread.
+ */
+struct NumaHeap {
+  using HandleType = H::MimHeapHandle;
+  /// Binds to the node of the constructing thread.
+  static constexpr int currentNode = -1;
+  /// Address space reserved for each node's arena.
+  static constexpr usize defaultArenaSize = usize(4) << 30;
+public:
+  explicit NumaHeap(int node = currentNode, 
+   usize arena_size = defaultArenaSize);
+  NumaHeap(NumaHeap&&) = default;
+  NumaHeap& operator=(NumaHeap&&) = default;
+
+  /// The node this heap was created for.
+  int node() const NOEXCEPT { return this->node_; }
+
+  /// `false` if the default heap is used instead.
+  bool isBound() const NOEXCEPT { return !this->heap_.isEmpty(); }
+
+  /// The underlying heap, empty if not bound.
+  const MimHeap& heap() const NOEXCEPT { return this->heap_; }
+
+  /// Creates an allocator bound to the heap.
+  template <typename T, H::SzType Align = alignof(T)>
+  MimHeapAllocator<T, Align> allocator() const NOEXCEPT {
+    return MimHeapAllocator<T, Align>(heap_.get());
+  }
+
+private:
+  MimHeap heap_ { nullptr };
+  int node_ = 0;
+};
+
+namespace H {
+  /// The current thread's `NumaHeap`, created on first use.
+  /// Returns null when it uses the default heap.
+  MimHeapHandle thread_numa_heap();
+} // namespace H
+
+/**
+ * @brief Stateless allocator which uses the current thread's node.
+ * 
+ * Each thread gets a `NumaHeap` on the node it first allocated from.
+ * Memory may be freed from any thread.
+ */
+template <typename T, H::SzType Align = alignof(T)>
+struct MSVC_EMPTY_BASES NumaAllocator 
+ : H::AlignedMimHeapBase<T, Align> {
+  static_assert(Align >= alignof(T), 
+    "Alignment requirement must be >= alignof(T).");
+public:
+  using value_type = T;
+  using pointer = T*;
+  using SmartAllocator = H::AlignedMimHeapBase<T, Align>;
+  using size_type = H::SzType;
+  using difference_type = std::ptrdiff_t;
+  using is_always_equal = H::TrueType;
+  using propagate_on_container_move_assignment = H::TrueType;
+
+  template <typename U, H::SzType UAlign = 
+    ((alignof(U) > Align) ? alignof(U) : Align)>
+  struct rebind {
+    using other = NumaAllocator<U, UAlign>;
+  };
+
+public:
+  constexpr NumaAllocator() NOEXCEPT = default;
+  constexpr NumaAllocator(const NumaAllocator&) NOEXCEPT = default;
+  template <typename U, H::SzType UAlign>
+  constexpr NumaAllocator(const NumaAllocator<U, UAlign>&) NOEXCEPT { }
+
+  //=== Member Functions ===//
+
+  NODISCARD static T* allocate(size_type n) {
+    return static_cast<T*>(SmartAllocator::
+      SmartAllocate(H::thread_numa_heap(), n));
+  }
+
+  static void deallocate(T* ptr, size_type n) {
+    EFLI_HEAPCHECK_(ptr);
+    return SmartAllocator::SmartDeallocate(ptr, n);
+  }
+};
+
+template <typename T1, typename T2, H::SzType A1, H::SzType A2>
+HINT_INLINE constexpr bool operator==(
+ const NumaAllocator<T1, A1>&, const NumaAllocator<T2, A2>&)
+ NOEXCEPT { return true; }
+
+#if CPPVER_MOST(17)
+template <typename T1, typename T2, H::SzType A1, H::SzType A2>
+HINT_INLINE constexpr bool operator!=(
+ const NumaAllocator<T1, A1>&, const NumaAllocator<T2, A2>&)
+ NOEXCEPT { return false; }
+#endif // Three-way Comparison Check (C++20)
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_NUMAHEAP_HPP
@@ -0,0 +1,192 @@
+//===- Core/PoolBoxAllocator.hpp ------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines a per-type slab pool for boxed objects.
+//  Blocks are cached in thread-local free lists, and slabs are
+//  laid out so small objects never straddle cache lines.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_POOLBOXALLOCATOR_HPP
+#define EFL_CORE_POOLBOXALLOCATOR_HPP
+
+#include <CoreCommon/Multithreaded.hpp>
+#include "Box.hpp"
+#include "Mtx.hpp"
+
+namespace efl {
+namespace C {
+namespace H {
+  GLOBAL SzType pool_cacheline = 64;
+  GLOBAL SzType pool_min_slab = 16 * 1024;
+  GLOBAL SzType pool_min_blocks = 32;
+
+  /// Intrusive links stored in free blocks.
+  struct PoolBlock {
+    PoolBlock* next;
+    union {
+      /// Only used by the first block of a batch.
+      PoolBlock* nextBatch;
+      /// Stored in the second block of a batch, if there is one.
+      std::ptrdiff_t batchSize;
+    };
+  };
+
+  FICONSTEXPR SzType pool_round_pow2(SzType n, SzType x = 1) NOEXCEPT {
+    return (x >= n) ? x : pool_round_pow2(n, x << 1);
+  }
+
+  FICONSTEXPR SzType pool_round_up(SzType n, SzType align) NOEXCEPT {
+    return (n + (align - 1)) & ~(align - 1);
+  }
+
+  /// Small blocks are rounded up to a power of 2, so they never
+  /// straddle cache lines. Others are rounded to a multiple of one.
+  FICONSTEXPR SzType pool_block_size(SzType size, SzType align) NOEXCEPT {
+    return pool_round_up(
+      (size <= pool_cacheline) 
+        ? pool_round_pow2(size, sizeof(PoolBlock))
+        : pool_round_up(size, pool_cacheline),
+      align);
+  }
+
+  /// State shared by all threads using a pool.
+  /// Slabs are owned here, and live for the entire program.
+  struct PoolShared {
+    PoolShared(SzType size, SzType align) NOEXCEPT;
+    PoolShared(const PoolShared&) = delete;
+  public:
+    const SzType blockSize;
+    const SzType slabAlign;
+    const SzType slabSize;
+    /// Max net frees on a thread before returning blocks.
+    const std::ptrdiff_t cacheMax;
+#if EFL_MULTITHREADED
+    C::Mtx mtx_;
+#endif
+    /// Stack of free lists returned by threads.
+    PoolBlock* batches_ = nullptr;
+  };
+
+  /// Per-thread cache of blocks for a single pool.
+  /// Frees go to the current thread, regardless of origin.
+  struct PoolCache {
+    explicit PoolCache(PoolShared& shared) NOEXCEPT
+     : shared_(&shared) { }
+    PoolCache(const PoolCache&) = delete;
+    /// Returns everything to the shared pool.
+    ~PoolCache();
+
+  public:
+    NODISCARD ALWAYS_INLINE void* allocate() NOEXCEPT {
+      if(EFL_LIKELY(this->head_)) {
+        PoolBlock* B = this->head_;
+        this->head_ = B->next;
+        --this->frees_;
+        return B;
+      }
+      if(EFL_LIKELY(this->cur_ != this->end_)) {
+        ubyte* p = this->cur_;
+        this->cur_ += shared_->blockSize;
+        return p;
+      }
+      return this->refill();
+    }
+
+    ALWAYS_INLINE void deallocate(void* p) NOEXCEPT {
+      auto* B = static_cast<PoolBlock*>(p);
+      B->next = this->head_;
+      this->head_ = B;
+      if(EFL_UNLIKELY(++this->frees_ > shared_->cacheMax))
+        this->flush();
+    }
+
+  private:
+    void* refill() NOEXCEPT;
+    void flush() NOEXCEPT;
+
+  private:
+    PoolShared* shared_;
+    PoolBlock* head_ = nullptr;
+    /// Number of blocks on the free list.
+    std::ptrdiff_t frees_ = 0;
+    /// Uncarved remainder of the last slab.
+    ubyte* cur_ = nullptr;
+    ubyte* end_ = nullptr;
+  };
+} // namespace H
+
+/**
+ * @brief Slab pool allocator for `Box<T>`.
+ * 
+ * Each `T` gets its own pool. Blocks are taken from the current
+ * thread's free list, which is refilled in bulk from the shared
+ * pool or a new slab. Blocks may be freed from any thread, they
+ * are simply cached by that thread instead. Memory is kept for reuse,
+ * and is never returned to the OS.
+ */
+template <typename T, 
+  H::SzType Align = alignof(T)>
+struct PoolBoxAllocator {
+  static_assert(H::is_power_of_2(Align), 
+    "Alignment MUST be a power of 2.");
+  using Type = T;
+  using value_type = T;
+  using pointer = T*;
+  using size_type = H::SzType;
+  static constexpr size_type blockSize = 
+    H::pool_block_size(sizeof(T), Align);
+public:
+  /// Constructs an object in a pooled block.
+  template <typename...Args>
+  static pointer New(Args&&...args) {
+    auto* data = static_cast<pointer>(Cache().allocate());
+    EFLI_DBGASSERT_(data != nullptr);
+    return X11::construct(data, FWD_CAST(args)...);
+  }
+
+  /// Destroys an object and returns its block to the pool.
+  static void Delete(pointer data) {
+    if(EFL_SOFT_UNLIKELY(!data)) return;
+    X11::destruct(data);
+    Cache().deallocate(data);
+  }
+
+  /// The pool's cache for the current thread.
+  static H::PoolCache& Cache() NOEXCEPT {
+    static EFL_THREADLOCAL H::PoolCache cache { Shared() };
+    return cache;
+  }
+
+private:
+  static H::PoolShared& Shared() NOEXCEPT {
+    static H::PoolShared shared { blockSize, Align };
+    return shared;
+  }
+};
+
+/// Alias for a `Box` using a `PoolBoxAllocator`.
+template <typename T>
+using PoolBox = Box<T, PoolBoxAllocator<T>>;
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_POOLBOXALLOCATOR_HPP
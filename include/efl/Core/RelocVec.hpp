@@ -0,0 +1,307 @@
+//===- Core/RelocVec.hpp --------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines a mimalloc-backed vector which uses the slack
+//  in each size class, and relocates trivially relocatable elements
+//  with memcpy.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_RELOCVEC_HPP
+#define EFL_CORE_RELOCVEC_HPP
+
+#include <cstring>
+#include "MimAllocator.hpp"
+
+namespace efl {
+namespace C {
+/// Specialize to allow relocating `T` with `memcpy`.
+/// A relocated object is never destroyed at its old address.
+template <typename T>
+struct IsTriviallyRelocatable 
+ : H::BoolC<is_trivially_copyable<T>::value> { };
+
+namespace H {
+  template <typename T, MEflEnableIf(
+    IsTriviallyRelocatable<T>::value)>
+  ALWAYS_INLINE void relocate_n(T* from, SzType n, T* to) NOEXCEPT {
+    if(EFL_LIKELY(n))
+      std::memcpy(static_cast<void*>(to), 
+        static_cast<const void*>(from), sizeof(T) * n);
+  }
+
+  template <typename T, MEflEnableIf(
+    !IsTriviallyRelocatable<T>::value)>
+  void relocate_n(T* from, SzType n, T* to) {
+    for(SzType I = 0; I < n; ++I) {
+      (void) X11::construct(to + I, cxpr_move(from[I]));
+      X11::destruct(from + I);
+    }
+  }
+} // namespace H
+
+/**
+ * @brief Vector which avoids copying when it grows.
+ * 
+ * When full, a new block is allocated with `allocate_at_least`,
+ * and the elements are relocated, in one `memcpy` if possible.
+ * The capacity is already the usable size of the block,
+ * so it is never grown in place.
+ */
+template <typename T, 
+  H::SzType Align = alignof(T)>
+struct RelocVec {
+  using SelfType = RelocVec<T, Align>;
+  using Alloc = MimAllocator<T, Align>;
+  using value_type = T;
+  using size_type = H::SzType;
+  using iterator = T*;
+  using const_iterator = const T*;
+public:
+  constexpr RelocVec() = default;
+
+  /// Creates a vector with `n` value-initialized elements.
+  explicit RelocVec(size_type n) {
+    this->resize(n);
+  }
+
+  /// Creates a vector with `n` zeroed elements.
+  /// The block comes straight from `mi_zalloc`, so no `memset`
+  /// is needed when the pages are fresh.
+  RelocVec(size_type n, zeroed_t) {
+    this->resize(n, zeroed);
+  }
+
+  RelocVec(H::InitList<T> il) {
+    this->append(il.begin(), il.end());
+  }
+
+  RelocVec(const RelocVec& rhs) {
+    this->append(rhs.begin(), rhs.end());
+  }
+
+  RelocVec(RelocVec&& rhs) NOEXCEPT 
+   : data_(rhs.data_), size_(rhs.size_), 
+   capacity_(rhs.capacity_) {
+    rhs.data_ = nullptr;
+    rhs.size_ = 0;
+    rhs.capacity_ = 0;
+  }
+
+  RelocVec& operator=(const RelocVec& rhs) {
+    if(EFL_UNLIKELY(this == &rhs)) 
+      return *this;
+    this->clear();
+    this->append(rhs.begin(), rhs.end());
+    return *this;
+  }
+
+  RelocVec& operator=(RelocVec&& rhs) NOEXCEPT {
+    RelocVec(H::cxpr_move(rhs)).swap(*this);
+    return *this;
+  }
+
+  ~RelocVec() { this->release(); }
+
+  //=== Member Functions ===//
+
+  iterator begin() NOEXCEPT { return data_; }
+  iterator end() NOEXCEPT { return data_ + size_; }
+  const_iterator begin() const NOEXCEPT { return data_; }
+  const_iterator end() const NOEXCEPT { return data_ + size_; }
+
+  T* data() NOEXCEPT { return data_; }
+  const T* data() const NOEXCEPT { return data_; }
+
+  T& operator[](size_type n) NOEXCEPT {
+    EFLI_DBGASSERT_(n < size_);
+    return data_[n];
+  }
+
+  const T& operator[](size_type n) const NOEXCEPT {
+    EFLI_DBGASSERT_(n < size_);
+    return data_[n];
+  }
+
+  T& front() NOEXCEPT { return (*this)[0]; }
+  const T& front() const NOEXCEPT { return (*this)[0]; }
+  T& back() NOEXCEPT { return (*this)[size_ - 1]; }
+  const T& back() const NOEXCEPT { return (*this)[size_ - 1]; }
+
+  size_type size() const NOEXCEPT { return size_; }
+  size_type capacity() const NOEXCEPT { return capacity_; }
+  size_type sizeInBytes() const NOEXCEPT { return size_ * sizeof(T); }
+  bool isEmpty() const NOEXCEPT { return size_ == 0; }
+
+  /// Ensures there is space for at least `n` elements.
+  void reserve(size_type n) {
+    if(n > capacity_)
+      this->grow(n);
+  }
+
+  void resize(size_type n) {
+    if(n <= size_) 
+      return this->truncate(n);
+    this->reserve(n);
+    for(size_type I = size_; I < n; ++I)
+      (void) X11::construct(data_ + I);
+    this->size_ = n;
+  }
+
+  void resize(size_type n, const T& value) {
+    if(n <= size_) 
+      return this->truncate(n);
+    this->reserve(n);
+    for(size_type I = size_; I < n; ++I)
+      (void) X11::construct(data_ + I, value);
+    this->size_ = n;
+  }
+
+  /// Resizes to `n`, zeroing any new elements.
+  void resize(size_type n, zeroed_t) {
+    static_assert(is_trivial<T>::value,
+      "Zeroed elements must be trivial.");
+    if(n <= size_) 
+      return this->truncate(n);
+    if(!data_) {
+      this->data_ = Alloc::allocate_zeroed(n);
+      $raw_assert(data_ != nullptr);
+      this->capacity_ = n;
+    } else {
+      this->reserve(n);
+      std::memset(static_cast<void*>(data_ + size_), 
+        0, sizeof(T) * (n - size_));
+    }
+    this->size_ = n;
+  }
+
+  template <typename...Args>
+  T& emplace_back(Args&&...args) {
+    if(EFL_UNLIKELY(size_ == capacity_))
+      return this->growEmplace(FWD_CAST(args)...);
+    T* p = X11::construct(data_ + size_, FWD_CAST(args)...);
+    ++this->size_;
+    return *p;
+  }
+
+  void push_back(const T& value) {
+    (void) this->emplace_back(value);
+  }
+
+  void push_back(T&& value) {
+    (void) this->emplace_back(H::cxpr_move(value));
+  }
+
+  void pop_back() NOEXCEPT {
+    EFLI_DBGASSERT_(size_ > 0);
+    X11::destruct(data_ + --size_);
+  }
+
+  /// Appends copies of `[first, last)`, which may be in this vector.
+  void append(const T* first, const T* last) {
+    const auto n = size_type(last - first);
+    if(n <= capacity_ - size_) {
+      for(size_type I = 0; I < n; ++I)
+        (void) X11::construct(data_ + size_ + I, first[I]);
+      this->size_ += n;
+      return;
+    }
+    // Copy first, the range may be in the old buffer.
+    auto res = this->allocateFor(size_ + n);
+    for(size_type I = 0; I < n; ++I)
+      (void) X11::construct(res.ptr + size_ + I, first[I]);
+    this->adopt(res);
+    this->size_ += n;
+  }
+
+  void clear() NOEXCEPT { this->truncate(0); }
+
+  void swap(RelocVec& rhs) NOEXCEPT {
+    std::swap(this->data_, rhs.data_);
+    std::swap(this->size_, rhs.size_);
+    std::swap(this->capacity_, rhs.capacity_);
+  }
+
+private:
+  void truncate(size_type n) NOEXCEPT {
+    for(size_type I = n; I < size_; ++I)
+      X11::destruct(data_ + I);
+    this->size_ = n;
+  }
+
+  void release() NOEXCEPT {
+    if(!data_) return;
+    this->truncate(0);
+    Alloc::deallocate(data_, capacity_);
+    this->data_ = nullptr;
+    this->capacity_ = 0;
+  }
+
+  /// The capacity to allocate when growing to at least `n`.
+  size_type nextCapacity(size_type n) const NOEXCEPT {
+    const size_type doubled = capacity_ * 2;
+    return (doubled > n) ? doubled : n;
+  }
+
+  /// Allocates a block for `n` or more, without moving anything.
+  AllocationResult<T*, size_type> allocateFor(size_type n) {
+    auto res = Alloc::allocate_at_least(this->nextCapacity(n));
+    if(EFL_UNLIKELY(!res.ptr)) {
+      // Retry with just what we need.
+      res = Alloc::allocate_at_least(n);
+      $raw_assert(res.ptr != nullptr);
+    }
+    return res;
+  }
+
+  /// Moves into `res`, and frees the old block.
+  void adopt(AllocationResult<T*, size_type> res) {
+    H::relocate_n(data_, size_, res.ptr);
+    if(data_) 
+      Alloc::deallocate(data_, capacity_);
+    this->data_ = res.ptr;
+    this->capacity_ = res.count;
+  }
+
+  /// Grows to at least `n`.
+  void grow(size_type n) {
+    this->adopt(this->allocateFor(n));
+  }
+
+  template <typename...Args>
+  EFL_COLD_PATH T& growEmplace(Args&&...args) {
+    // Construct first, `args` may point into the old buffer.
+    auto res = this->allocateFor(size_ + 1);
+    T* p = X11::construct(res.ptr + size_, FWD_CAST(args)...);
+    this->adopt(res);
+    ++this->size_;
+    return *p;
+  }
+
+private:
+  T* data_ = nullptr;
+  size_type size_ = 0;
+  size_type capacity_ = 0;
+};
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_RELOCVEC_HPP
@@ -0,0 +1,415 @@
+//===- Core/RingBuf.hpp ---------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines RingBuf<...>, a contiguous double-ended queue
+//  with a power of 2 capacity. Elements can be pushed and popped in
+//  bulk, and viewed as at most two ArrayRefs.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_RINGBUF_HPP
+#define EFL_CORE_RINGBUF_HPP
+
+#include <iterator>
+#include "ArrayRef.hpp"
+#include "Bits.hpp"
+#include "RelocVec.hpp"
+
+namespace efl {
+namespace C {
+namespace H {
+  GLOBAL SzType ring_min_capacity = 8;
+
+  /// Copy constructs `n` elements into uninitialized memory.
+  template <typename T, MEflEnableIf(
+    is_trivially_copyable<T>::value)>
+  ALWAYS_INLINE void ring_copy_n(
+   const T* from, SzType n, T* to) NOEXCEPT {
+    if(EFL_LIKELY(n))
+      std::memcpy(static_cast<void*>(to), 
+        static_cast<const void*>(from), sizeof(T) * n);
+  }
+
+  template <typename T, MEflEnableIf(
+    !is_trivially_copyable<T>::value)>
+  void ring_copy_n(const T* from, SzType n, T* to) {
+    for(SzType I = 0; I < n; ++I)
+      (void) X11::construct(to + I, from[I]);
+  }
+
+  /// Move assigns `n` elements, then destroys the sources.
+  template <typename T, MEflEnableIf(
+    is_trivially_copyable<T>::value)>
+  ALWAYS_INLINE void ring_take_n(
+   T* from, SzType n, T* to) NOEXCEPT {
+    if(EFL_LIKELY(n))
+      std::memcpy(static_cast<void*>(to), 
+        static_cast<const void*>(from), sizeof(T) * n);
+  }
+
+  template <typename T, MEflEnableIf(
+    !is_trivially_copyable<T>::value)>
+  void ring_take_n(T* from, SzType n, T* to) {
+    for(SzType I = 0; I < n; ++I) {
+      to[I] = cxpr_move(from[I]);
+      X11::destruct(from + I);
+    }
+  }
+
+  template <typename Ring, typename T>
+  struct RingIter {
+    using value_type = remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using pointer = T*;
+    using iterator_category = std::bidirectional_iterator_tag;
+  public:
+    RingIter() = default;
+    RingIter(Ring* ring, SzType I) NOEXCEPT
+     : ring_(ring), index_(I) { }
+
+    template <typename T2, MEflEnableIf(
+      !std::is_same<T, T2>::value)>
+    RingIter(const RingIter<remove_const_t<Ring>, T2>& it) NOEXCEPT
+     : ring_(it.ring_), index_(it.index_) { }
+
+    reference operator*() const NOEXCEPT 
+    { return (*ring_)[index_]; }
+    pointer operator->() const NOEXCEPT 
+    { return &(*ring_)[index_]; }
+
+    RingIter& operator++() NOEXCEPT { ++this->index_; return *this; }
+    RingIter& operator--() NOEXCEPT { --this->index_; return *this; }
+
+    RingIter operator++(int) NOEXCEPT {
+      RingIter it = *this;
+      ++this->index_;
+      return it;
+    }
+
+    RingIter operator--(int) NOEXCEPT {
+      RingIter it = *this;
+      --this->index_;
+      return it;
+    }
+
+    friend difference_type operator-(
+     const RingIter& l, const RingIter& r) NOEXCEPT {
+      return difference_type(l.index_ - r.index_);
+    }
+
+    friend bool operator==(
+     const RingIter& l, const RingIter& r) NOEXCEPT {
+      return l.index_ == r.index_;
+    }
+
+    friend bool operator!=(
+     const RingIter& l, const RingIter& r) NOEXCEPT {
+      return l.index_ != r.index_;
+    }
+
+  public:
+    Ring* ring_ = nullptr;
+    SzType index_ = 0;
+  };
+} // namespace H
+
+/// The contents of a `RingBuf`, in order. `second` is empty
+/// unless the elements wrap around the end of the buffer.
+template <typename Ref>
+struct RingSlices {
+  H::SzType size() const NOEXCEPT 
+  { return first.size() + second.size(); }
+public:
+  Ref first;
+  Ref second;
+};
+
+/**
+ * @brief Contiguous double-ended queue.
+ * 
+ * The capacity is always a power of 2, so positions are masked
+ * instead of wrapped. Grows like `RelocVec<T>`, but never shrinks.
+ * Pushing or popping at either end does not move elements.
+ */
+template <typename T>
+struct RingBuf {
+  using SelfType = RingBuf<T>;
+  using Alloc = MimAllocator<T>;
+  using value_type = T;
+  using size_type = H::SzType;
+  using difference_type = std::ptrdiff_t;
+  using iterator = H::RingIter<RingBuf, T>;
+  using const_iterator = H::RingIter<const RingBuf, const T>;
+  using Slices = RingSlices<ArrayRef<T>>;
+  using ConstSlices = RingSlices<ImmutArrayRef<T>>;
+public:
+  RingBuf() = default;
+
+  /// Reserves space for at least `n` elements.
+  explicit RingBuf(size_type n) { this->reserve(n); }
+
+  RingBuf(H::InitList<T> il) {
+    this->pushBack(ImmutArrayRef<T>(il.begin(), il.end()));
+  }
+
+  RingBuf(const RingBuf& rhs) {
+    const ConstSlices slices = rhs.twoSlices();
+    this->reserve(rhs.size_);
+    this->pushBack(slices.first);
+    this->pushBack(slices.second);
+  }
+
+  RingBuf(RingBuf&& rhs) NOEXCEPT
+   : data_(rhs.data_), head_(rhs.head_),
+   size_(rhs.size_), capacity_(rhs.capacity_) {
+    rhs.data_ = nullptr;
+    rhs.head_ = rhs.size_ = rhs.capacity_ = 0;
+  }
+
+  RingBuf& operator=(const RingBuf& rhs) {
+    if(EFL_UNLIKELY(this == &rhs))
+      return *this;
+    RingBuf tmp(rhs);
+    this->swap(tmp);
+    return *this;
+  }
+
+  RingBuf& operator=(RingBuf&& rhs) NOEXCEPT {
+    if(EFL_UNLIKELY(this == &rhs))
+      return *this;
+    RingBuf tmp(H::cxpr_move(rhs));
+    this->swap(tmp);
+    return *this;
+  }
+
+  ~RingBuf() { this->release(); }
+
+  //=== Iterators ===//
+
+  iterator begin() NOEXCEPT { return iterator(this, 0); }
+  iterator end() NOEXCEPT { return iterator(this, size_); }
+  const_iterator begin() const NOEXCEPT 
+  { return const_iterator(this, 0); }
+  const_iterator end() const NOEXCEPT 
+  { return const_iterator(this, size_); }
+
+  //=== Element Access ===//
+
+  T& operator[](size_type I) NOEXCEPT {
+    EFLI_DBGASSERT_(I < size_);
+    return data_[(head_ + I) & this->mask()];
+  }
+
+  const T& operator[](size_type I) const NOEXCEPT {
+    EFLI_DBGASSERT_(I < size_);
+    return data_[(head_ + I) & this->mask()];
+  }
+
+  T& front() NOEXCEPT { return (*this)[0]; }
+  const T& front() const NOEXCEPT { return (*this)[0]; }
+  T& back() NOEXCEPT { return (*this)[size_ - 1]; }
+  const T& back() const NOEXCEPT { return (*this)[size_ - 1]; }
+
+  /// Returns the elements as at most two contiguous spans,
+  /// eg. for a `writev` with two `iovec`s.
+  Slices twoSlices() NOEXCEPT {
+    const size_type n = this->firstSliceSize();
+    return { ArrayRef<T>(data_ + head_, n), 
+      ArrayRef<T>(data_, size_ - n) };
+  }
+
+  ConstSlices twoSlices() const NOEXCEPT {
+    const size_type n = this->firstSliceSize();
+    return { ImmutArrayRef<T>(data_ + head_, n), 
+      ImmutArrayRef<T>(data_, size_ - n) };
+  }
+
+  //=== Observers ===//
+
+  size_type size() const NOEXCEPT { return size_; }
+  size_type capacity() const NOEXCEPT { return capacity_; }
+  bool isEmpty() const NOEXCEPT { return size_ == 0; }
+  bool isFull() const NOEXCEPT { return size_ == capacity_; }
+
+  //=== Modifiers ===//
+
+  template <typename...Args>
+  T& emplace_back(Args&&...args) {
+    if(EFL_UNLIKELY(this->isFull()))
+      return this->growEmplace(false, FWD_CAST(args)...);
+    T* p = data_ + ((head_ + size_) & this->mask());
+    (void) X11::construct(p, FWD_CAST(args)...);
+    ++this->size_;
+    return *p;
+  }
+
+  template <typename...Args>
+  T& emplace_front(Args&&...args) {
+    if(EFL_UNLIKELY(this->isFull()))
+      return this->growEmplace(true, FWD_CAST(args)...);
+    const size_type head = (head_ - 1) & this->mask();
+    (void) X11::construct(data_ + head, FWD_CAST(args)...);
+    this->head_ = head;
+    ++this->size_;
+    return data_[head];
+  }
+
+  void push_back(const T& t) { (void) this->emplace_back(t); }
+  void push_back(T&& t) { (void) this->emplace_back(H::cxpr_move(t)); }
+  void push_front(const T& t) { (void) this->emplace_front(t); }
+  void push_front(T&& t) { (void) this->emplace_front(H::cxpr_move(t)); }
+
+  void pop_back() NOEXCEPT {
+    EFLI_DBGASSERT_(size_ > 0);
+    --this->size_;
+    X11::destruct(data_ + ((head_ + size_) & this->mask()));
+  }
+
+  void pop_front() NOEXCEPT {
+    EFLI_DBGASSERT_(size_ > 0);
+    X11::destruct(data_ + head_);
+    this->head_ = (head_ + 1) & this->mask();
+    --this->size_;
+  }
+
+  /// Copies every element of `arr` to the back, growing once.
+  /// `arr` must not point into this buffer.
+  void pushBack(ImmutArrayRef<T> arr) {
+    const size_type n = arr.size_;
+    if(n > capacity_ - size_)
+      this->grow(size_ + n);
+    const size_type tail = (head_ + size_) & this->mask();
+    const size_type room = capacity_ - tail;
+    const size_type first = (n < room) ? n : room;
+    H::ring_copy_n(arr.data_, first, data_ + tail);
+    H::ring_copy_n(arr.data_ + first, n - first, data_);
+    this->size_ += n;
+  }
+
+  /// Moves up to `out.size()` elements from the front into `out`.
+  /// Returns the number of elements popped.
+  size_type popFront(ArrayRef<T> out) {
+    const size_type n = (out.size_ < size_) ? out.size_ : size_;
+    const size_type room = capacity_ - head_;
+    const size_type first = (n < room) ? n : room;
+    H::ring_take_n(data_ + head_, first, out.data_);
+    H::ring_take_n(data_, n - first, out.data_ + first);
+    this->head_ = (head_ + n) & this->mask();
+    this->size_ -= n;
+    return n;
+  }
+
+  /// Destroys the first `n` elements, eg. after a partial write.
+  void dropFront(size_type n) NOEXCEPT {
+    EFLI_DBGASSERT_(n <= size_);
+    for(size_type I = 0; I < n; ++I)
+      this->pop_front();
+  }
+
+  /// Destroys every element, keeping the buffer.
+  void clear() NOEXCEPT {
+    this->dropFront(size_);
+    this->head_ = 0;
+  }
+
+  /// Ensures `n` elements fit without reallocating.
+  void reserve(size_type n) {
+    if(n > capacity_)
+      this->grow(n);
+  }
+
+  void swap(RingBuf& rhs) NOEXCEPT {
+    std::swap(this->data_, rhs.data_);
+    std::swap(this->head_, rhs.head_);
+    std::swap(this->size_, rhs.size_);
+    std::swap(this->capacity_, rhs.capacity_);
+  }
+
+private:
+  ALWAYS_INLINE size_type mask() const NOEXCEPT {
+    return capacity_ - 1;
+  }
+
+  size_type firstSliceSize() const NOEXCEPT {
+    const size_type room = capacity_ - head_;
+    return (size_ < room) ? size_ : room;
+  }
+
+  /// The capacity to grow to when fitting `n`.
+  size_type nextCapacity(size_type n) const NOEXCEPT {
+    size_type cap = capacity_ * 2;
+    if(cap < n) cap = n;
+    if(cap < H::ring_min_capacity) cap = H::ring_min_capacity;
+    return bit_ceil(cap);
+  }
+
+  /// Reallocates to fit `n`, and unwraps the elements.
+  EFL_COLD_PATH void grow(size_type n) {
+    const size_type cap = this->nextCapacity(n);
+    T* data = Alloc::allocate(cap);
+    $raw_assert(data != nullptr);
+    this->adopt(data, cap);
+  }
+
+  /// Grows by one, pushing to the front or back.
+  template <typename...Args>
+  EFL_COLD_PATH T& growEmplace(bool front, Args&&...args) {
+    const size_type cap = this->nextCapacity(size_ + 1);
+    T* data = Alloc::allocate(cap);
+    $raw_assert(data != nullptr);
+    // Construct first, `args` may point into the old buffer.
+    const size_type pos = front ? (cap - 1) : size_;
+    T* p = X11::construct(data + pos, FWD_CAST(args)...);
+    this->adopt(data, cap);
+    if(front) this->head_ = pos;
+    ++this->size_;
+    return *p;
+  }
+
+  /// Moves the elements to `data`, unwrapping them.
+  void adopt(T* data, size_type cap) {
+    const size_type first = this->firstSliceSize();
+    H::relocate_n(data_ + head_, first, data);
+    H::relocate_n(data_, size_ - first, data + first);
+    if(data_)
+      Alloc::deallocate(data_, capacity_);
+    this->data_ = data;
+    this->head_ = 0;
+    this->capacity_ = cap;
+  }
+
+  void release() NOEXCEPT {
+    if(!data_) return;
+    this->dropFront(size_);
+    Alloc::deallocate(data_, capacity_);
+  }
+
+private:
+  T* data_ = nullptr;
+  size_type head_ = 0;
+  size_type size_ = 0;
+  size_type capacity_ = 0;
+};
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_RINGBUF_HPP
@@ -0,0 +1,471 @@
+//===- Core/SmallVec.hpp --------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines a vector which stores its first N elements
+//  inline, and spills to mimalloc beyond that. 
+//  Based on llvm::SmallVector<...>.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_SMALLVEC_HPP
+#define EFL_CORE_SMALLVEC_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include "RelocVec.hpp"
+
+namespace efl {
+namespace C {
+namespace H {
+  template <typename T>
+  struct SmallVecHeader {
+    T* data_;
+    SzType size_;
+    SzType capacity_;
+    /// Restored when the heap block is given away.
+    SzType smallCapacity_;
+  };
+
+  /// Used to find where the inline elements begin.
+  template <typename T>
+  struct SmallVecLayout {
+    SmallVecHeader<T> header;
+    alignas(T) ubyte first[sizeof(T)];
+  };
+
+  template <typename T, SzType N>
+  struct SmallVecStorage {
+    alignas(T) ubyte inline_[sizeof(T) * N];
+  };
+
+  template <typename T>
+  struct SmallVecStorage<T, 0> { };
+
+  /// Fills a cache line, with at least one inline element.
+  template <typename T>
+  FICONSTEXPR SzType small_vec_default_n() NOEXCEPT {
+    return (sizeof(T) * 2 + sizeof(SmallVecHeader<T>) > 64) ? 1
+      : (64 - sizeof(SmallVecHeader<T>)) / sizeof(T);
+  }
+} // namespace H
+
+/**
+ * @brief Size-erased interface of `SmallVec<T, N>`.
+ * 
+ * Can't be constructed directly, take it by reference
+ * to avoid templating on the inline size.
+ */
+template <typename T>
+struct SmallVecImpl : protected H::SmallVecHeader<T> {
+  using SelfType = SmallVecImpl<T>;
+  using Alloc = MimAllocator<T>;
+  using value_type = T;
+  using size_type = H::SzType;
+  using difference_type = std::ptrdiff_t;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+protected:
+  explicit SmallVecImpl(size_type n_inline) NOEXCEPT {
+    this->data_ = this->inlineData();
+    this->size_ = 0;
+    this->capacity_ = n_inline;
+    this->smallCapacity_ = n_inline;
+  }
+
+  ~SmallVecImpl() { this->release(); }
+
+public:
+  SmallVecImpl(const SmallVecImpl&) = delete;
+
+  SmallVecImpl& operator=(const SmallVecImpl& rhs) {
+    if(EFL_UNLIKELY(this == &rhs)) 
+      return *this;
+    this->clear();
+    this->append(rhs.begin(), rhs.end());
+    return *this;
+  }
+
+  SmallVecImpl& operator=(SmallVecImpl&& rhs) {
+    if(EFL_UNLIKELY(this == &rhs)) 
+      return *this;
+    if(!rhs.isSmall()) {
+      // Steal the heap block.
+      this->release();
+      this->data_ = rhs.data_;
+      this->size_ = rhs.size_;
+      this->capacity_ = rhs.capacity_;
+      rhs.resetToSmall();
+      return *this;
+    }
+    this->clear();
+    this->reserve(rhs.size_);
+    H::relocate_n(rhs.data_, rhs.size_, this->data_);
+    this->size_ = rhs.size_;
+    rhs.size_ = 0;
+    return *this;
+  }
+
+  //=== Iterators ===//
+
+  iterator begin() NOEXCEPT { return this->data_; }
+  iterator end() NOEXCEPT { return this->data_ + this->size_; }
+  const_iterator begin() const NOEXCEPT { return this->data_; }
+  const_iterator end() const NOEXCEPT { return this->data_ + this->size_; }
+  reverse_iterator rbegin() NOEXCEPT { return reverse_iterator(end()); }
+  reverse_iterator rend() NOEXCEPT { return reverse_iterator(begin()); }
+
+  const_reverse_iterator rbegin() const NOEXCEPT 
+  { return const_reverse_iterator(end()); }
+
+  const_reverse_iterator rend() const NOEXCEPT 
+  { return const_reverse_iterator(begin()); }
+
+  //=== Element Access ===//
+
+  T* data() NOEXCEPT { return this->data_; }
+  const T* data() const NOEXCEPT { return this->data_; }
+
+  T& operator[](size_type n) NOEXCEPT {
+    EFLI_DBGASSERT_(n < this->size_);
+    return this->data_[n];
+  }
+
+  const T& operator[](size_type n) const NOEXCEPT {
+    EFLI_DBGASSERT_(n < this->size_);
+    return this->data_[n];
+  }
+
+  T& front() NOEXCEPT { return (*this)[0]; }
+  const T& front() const NOEXCEPT { return (*this)[0]; }
+  T& back() NOEXCEPT { return (*this)[this->size_ - 1]; }
+  const T& back() const NOEXCEPT { return (*this)[this->size_ - 1]; }
+
+  //=== Observers ===//
+
+  size_type size() const NOEXCEPT { return this->size_; }
+  size_type capacity() const NOEXCEPT { return this->capacity_; }
+  size_type sizeInBytes() const NOEXCEPT { return this->size_ * sizeof(T); }
+  bool isEmpty() const NOEXCEPT { return this->size_ == 0; }
+
+  /// Check if the elements are stored inline.
+  bool isSmall() const NOEXCEPT {
+    return this->data_ == this->inlineData();
+  }
+
+  //=== Modifiers ===//
+
+  /// Ensures there is space for at least `n` elements.
+  void reserve(size_type n) {
+    if(n > this->capacity_)
+      this->grow(n);
+  }
+
+  void resize(size_type n) {
+    if(n <= this->size_) 
+      return this->truncate(n);
+    this->reserve(n);
+    for(size_type I = this->size_; I < n; ++I)
+      (void) X11::construct(this->data_ + I);
+    this->size_ = n;
+  }
+
+  void resize(size_type n, const T& value) {
+    if(n <= this->size_) 
+      return this->truncate(n);
+    this->reserve(n);
+    for(size_type I = this->size_; I < n; ++I)
+      (void) X11::construct(this->data_ + I, value);
+    this->size_ = n;
+  }
+
+  template <typename...Args>
+  T& emplace_back(Args&&...args) {
+    if(EFL_UNLIKELY(this->size_ == this->capacity_))
+      return this->growEmplace(FWD_CAST(args)...);
+    T* p = X11::construct(this->data_ + this->size_, FWD_CAST(args)...);
+    ++this->size_;
+    return *p;
+  }
+
+  void push_back(const T& value) {
+    (void) this->emplace_back(value);
+  }
+
+  void push_back(T&& value) {
+    (void) this->emplace_back(H::cxpr_move(value));
+  }
+
+  void pop_back() NOEXCEPT {
+    EFLI_DBGASSERT_(this->size_ > 0);
+    X11::destruct(this->data_ + --this->size_);
+  }
+
+  /// Removes and returns the last element.
+  T popBackVal() {
+    T value = H::cxpr_move(this->back());
+    this->pop_back();
+    return value;
+  }
+
+  /// Appends copies of `[first, last)`, which may be in this vector.
+  void append(const T* first, const T* last) {
+    const auto n = size_type(last - first);
+    if(n <= this->capacity_ - this->size_) {
+      for(size_type I = 0; I < n; ++I)
+        (void) X11::construct(this->data_ + this->size_ + I, first[I]);
+      this->size_ += n;
+      return;
+    }
+    // Copy first, the range may be in the old buffer.
+    auto res = this->allocateFor(this->size_ + n);
+    for(size_type I = 0; I < n; ++I)
+      (void) X11::construct(res.ptr + this->size_ + I, first[I]);
+    this->adopt(res);
+    this->size_ += n;
+  }
+
+  void append(H::InitList<T> il) {
+    this->append(il.begin(), il.end());
+  }
+
+  /// Constructs an element before `pos`.
+  template <typename...Args>
+  iterator emplace(const_iterator pos, Args&&...args) {
+    const auto n = size_type(pos - this->begin());
+    EFLI_DBGASSERT_(n <= this->size_);
+    if(n == this->size_) {
+      this->emplace_back(FWD_CAST(args)...);
+      return this->begin() + n;
+    }
+    // Construct first, `args` may point into the buffer.
+    T value(FWD_CAST(args)...);
+    this->emplace_back(H::cxpr_move(this->back()));
+    iterator I = this->begin() + n;
+    std::move_backward(I, this->end() - 2, this->end() - 1);
+    *I = H::cxpr_move(value);
+    return I;
+  }
+
+  iterator insert(const_iterator pos, const T& value) {
+    return this->emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T&& value) {
+    return this->emplace(pos, H::cxpr_move(value));
+  }
+
+  iterator erase(const_iterator pos) {
+    return this->erase(pos, pos + 1);
+  }
+
+  /// Removes `[first, last)`, shifting the tail down.
+  iterator erase(const_iterator first, const_iterator last) {
+    iterator I = this->begin() + (first - this->begin());
+    const auto n = size_type(last - first);
+    std::move(I + n, this->end(), I);
+    this->truncate(this->size_ - n);
+    return I;
+  }
+
+  void clear() NOEXCEPT { this->truncate(0); }
+
+  void swap(SmallVecImpl& rhs) {
+    if(EFL_UNLIKELY(this == &rhs)) 
+      return;
+    if(!this->isSmall() && !rhs.isSmall()) {
+      std::swap(this->data_, rhs.data_);
+      std::swap(this->size_, rhs.size_);
+      std::swap(this->capacity_, rhs.capacity_);
+      return;
+    }
+    // Inline elements can't be swapped by pointer.
+    this->reserve(rhs.size_);
+    rhs.reserve(this->size_);
+    SmallVecImpl& lo = (this->size_ < rhs.size_) ? *this : rhs;
+    SmallVecImpl& hi = (this->size_ < rhs.size_) ? rhs : *this;
+    const size_type common = lo.size_;
+    for(size_type I = 0; I < common; ++I)
+      std::swap(lo.data_[I], hi.data_[I]);
+    for(size_type I = common; I < hi.size_; ++I)
+      (void) X11::construct(lo.data_ + I, H::cxpr_move(hi.data_[I]));
+    lo.size_ = hi.size_;
+    hi.truncate(common);
+  }
+
+private:
+  T* inlineData() const NOEXCEPT {
+    auto* self = reinterpret_cast<const ubyte*>(this);
+    return reinterpret_cast<T*>(const_cast<ubyte*>(
+      self + offsetof(H::SmallVecLayout<T>, first)));
+  }
+
+  /// Moved-from vectors go back to their inline buffer.
+  void resetToSmall() NOEXCEPT {
+    this->data_ = this->inlineData();
+    this->size_ = 0;
+    this->capacity_ = this->smallCapacity_;
+  }
+
+  void truncate(size_type n) NOEXCEPT {
+    for(size_type I = n; I < this->size_; ++I)
+      X11::destruct(this->data_ + I);
+    this->size_ = n;
+  }
+
+  void release() NOEXCEPT {
+    this->truncate(0);
+    if(!this->isSmall())
+      Alloc::deallocate(this->data_, this->capacity_);
+  }
+
+  /// The capacity to allocate when growing to at least `n`.
+  size_type nextCapacity(size_type n) const NOEXCEPT {
+    const size_type doubled = this->capacity_ * 2;
+    return (doubled > n) ? doubled : n;
+  }
+
+  /// Allocates a block for `n` or more, without moving anything.
+  AllocationResult<T*, size_type> allocateFor(size_type n) {
+    auto res = Alloc::allocate_at_least(this->nextCapacity(n));
+    if(EFL_UNLIKELY(!res.ptr)) {
+      // Retry with just what we need.
+      res = Alloc::allocate_at_least(n);
+      $raw_assert(res.ptr != nullptr);
+    }
+    return res;
+  }
+
+  /// Moves into `res`, and frees the old block if on the heap.
+  void adopt(AllocationResult<T*, size_type> res) {
+    H::relocate_n(this->data_, this->size_, res.ptr);
+    if(!this->isSmall()) 
+      Alloc::deallocate(this->data_, this->capacity_);
+    this->data_ = res.ptr;
+    this->capacity_ = res.count;
+  }
+
+  /// Grows to at least `n`. Heap blocks are already at their
+  /// usable size, so they are never grown in place.
+  void grow(size_type n) {
+    this->adopt(this->allocateFor(n));
+  }
+
+  template <typename...Args>
+  EFL_COLD_PATH T& growEmplace(Args&&...args) {
+    const size_type n = this->size_ + 1;
+    // Construct first, `args` may point into the old buffer.
+    auto res = this->allocateFor(n);
+    T* p = X11::construct(res.ptr + this->size_, FWD_CAST(args)...);
+    this->adopt(res);
+    ++this->size_;
+    return *p;
+  }
+};
+
+/**
+ * @brief Vector with inline storage for `N` elements.
+ * 
+ * Only touches the heap when it grows past `N`,
+ * after which it behaves like `RelocVec<T>`.
+ */
+template <typename T, 
+  H::SzType N = H::small_vec_default_n<T>()>
+struct MSVC_EMPTY_BASES SmallVec 
+ : SmallVecImpl<T>, H::SmallVecStorage<T, N> {
+  using SelfType = SmallVec<T, N>;
+  using BaseType = SmallVecImpl<T>;
+  using size_type = H::SzType;
+  static constexpr size_type inlineCapacity = N;
+public:
+  SmallVec() NOEXCEPT : BaseType(N) { 
+    EFLI_DBGASSERT_(this->isSmall());
+  }
+
+  /// Creates a vector with `n` value-initialized elements.
+  explicit SmallVec(size_type n) : SmallVec() {
+    this->resize(n);
+  }
+
+  SmallVec(size_type n, const T& value) : SmallVec() {
+    this->resize(n, value);
+  }
+
+  SmallVec(const T* first, const T* last) : SmallVec() {
+    this->append(first, last);
+  }
+
+  SmallVec(H::InitList<T> il) : SmallVec() {
+    this->append(il.begin(), il.end());
+  }
+
+  SmallVec(const SmallVec& rhs) : SmallVec() {
+    this->append(rhs.begin(), rhs.end());
+  }
+
+  SmallVec(const BaseType& rhs) : SmallVec() {
+    this->append(rhs.begin(), rhs.end());
+  }
+
+  SmallVec(SmallVec&& rhs) : SmallVec() {
+    BaseType::operator=(H::cxpr_move(rhs));
+  }
+
+  SmallVec(BaseType&& rhs) : SmallVec() {
+    BaseType::operator=(H::cxpr_move(rhs));
+  }
+
+  ~SmallVec() { this->clear(); }
+
+  SmallVec& operator=(const SmallVec& rhs) {
+    BaseType::operator=(rhs);
+    return *this;
+  }
+
+  SmallVec& operator=(SmallVec&& rhs) {
+    BaseType::operator=(H::cxpr_move(rhs));
+    return *this;
+  }
+
+  SmallVec& operator=(H::InitList<T> il) {
+    this->clear();
+    this->append(il.begin(), il.end());
+    return *this;
+  }
+};
+
+template <typename T>
+bool operator==(const SmallVecImpl<T>& lhs, const SmallVecImpl<T>& rhs) {
+  if(lhs.size() != rhs.size()) return false;
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+#if CPPVER_MOST(17)
+template <typename T>
+bool operator!=(const SmallVecImpl<T>& lhs, const SmallVecImpl<T>& rhs) {
+  return !(lhs == rhs);
+}
+#endif // Three-way Comparison Check (C++20)
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_SMALLVEC_HPP
@@ -0,0 +1,246 @@
+//===- Core/SpscQueue.hpp -------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines SpscQueue<...>, a bounded wait-free queue
+//  for handing values from one producer thread to one consumer.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_SPSCQUEUE_HPP
+#define EFL_CORE_SPSCQUEUE_HPP
+
+#include <atomic>
+#include <CoreCommon/Multithreaded.hpp>
+#include "ArrayRef.hpp"
+#include "Bits.hpp"
+#include "MimAllocator.hpp"
+
+namespace efl {
+namespace C {
+namespace H {
+  /// Assumed size of a cache line, used to avoid false sharing.
+  GLOBAL SzType queue_cacheline = 64;
+
+  /// Stand-in for `std::atomic<T>` in single threaded builds.
+  template <typename T>
+  struct NonAtomic {
+    NonAtomic() = default;
+    constexpr NonAtomic(T t) NOEXCEPT : value_(t) { }
+
+    ALWAYS_INLINE T load(std::memory_order) const NOEXCEPT {
+      return value_;
+    }
+
+    ALWAYS_INLINE void store(T t, std::memory_order) NOEXCEPT {
+      this->value_ = t;
+    }
+
+    ALWAYS_INLINE bool compare_exchange_weak(T& expected, T desired,
+     std::memory_order, std::memory_order) NOEXCEPT {
+      if(value_ != expected) {
+        expected = value_;
+        return false;
+      }
+      this->value_ = desired;
+      return true;
+    }
+  public:
+    T value_ { };
+  };
+
+  /// `std::atomic<T>` if `EFL_MULTITHREADED`, otherwise plain.
+  template <typename T>
+  using QueueAtomic = conditional_t<EFL_MULTITHREADED,
+    std::atomic<T>, NonAtomic<T>>;
+
+  /// Gives `T` a cache line to itself.
+  template <typename T>
+  struct alignas(queue_cacheline) CachePadded {
+    T value;
+  };
+} // namespace H
+
+/**
+ * @brief Bounded single-producer/single-consumer queue.
+ * 
+ * Every operation is wait-free, and either succeeds fully
+ * or does nothing (batches may be partial). Exactly one thread
+ * may push, and exactly one thread may pop, at any time.
+ * 
+ * The producer and consumer indices live on separate cache lines,
+ * and each side caches the other's index, so the shared lines
+ * are only touched when the cached view runs out.
+ */
+template <typename T>
+struct SpscQueue {
+  using SelfType = SpscQueue<T>;
+  using Alloc = MimAllocator<T, (alignof(T) > H::queue_cacheline)
+    ? alignof(T) : H::queue_cacheline>;
+  using value_type = T;
+  using size_type = H::SzType;
+public:
+  /// Creates a queue holding at least `capacity` elements.
+  /// The capacity is rounded up to a power of 2.
+  explicit SpscQueue(size_type capacity)
+   : capacity_(bit_ceil(capacity < 2 ? 2 : capacity)), 
+   data_(Alloc::allocate(capacity_)) {
+    $raw_assert(data_ != nullptr);
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  /// Destroys anything left in the queue.
+  ~SpscQueue() {
+    const size_type head = head_.value.load(std::memory_order_relaxed);
+    const size_type tail = tail_.value.load(std::memory_order_relaxed);
+    for(size_type I = head; I != tail; ++I)
+      X11::destruct(this->slot(I));
+    Alloc::deallocate(data_, capacity_);
+  }
+
+  //=== Producer ===//
+
+  /// Constructs an element at the back, fails if full.
+  template <typename...Args>
+  bool tryEmplace(Args&&...args) {
+    const size_type tail = tail_.value.load(std::memory_order_relaxed);
+    if(EFL_UNLIKELY(tail - cachedHead_.value == capacity_)) {
+      this->cachedHead_.value = 
+        head_.value.load(std::memory_order_acquire);
+      if(tail - cachedHead_.value == capacity_)
+        return false;
+    }
+    (void) X11::construct(this->slot(tail), FWD_CAST(args)...);
+    this->tail_.value.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool tryPush(const T& t) { return this->tryEmplace(t); }
+  bool tryPush(T&& t) { return this->tryEmplace(H::cxpr_move(t)); }
+
+  /// Copies as much of `arr` as fits, publishing it all at once.
+  /// Returns the number of elements pushed.
+  size_type tryPushBatch(ImmutArrayRef<T> arr) {
+    const size_type tail = tail_.value.load(std::memory_order_relaxed);
+    size_type room = capacity_ - (tail - cachedHead_.value);
+    if(room < arr.size_) {
+      this->cachedHead_.value = 
+        head_.value.load(std::memory_order_acquire);
+      room = capacity_ - (tail - cachedHead_.value);
+    }
+    const size_type n = (arr.size_ < room) ? arr.size_ : room;
+    for(size_type I = 0; I < n; ++I)
+      (void) X11::construct(this->slot(tail + I), arr.data_[I]);
+    if(n)
+      this->tail_.value.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  //=== Consumer ===//
+
+  /// Moves the front element into `out`, fails if empty.
+  bool tryPop(T& out) {
+    const size_type head = head_.value.load(std::memory_order_relaxed);
+    if(EFL_UNLIKELY(head == cachedTail_.value)) {
+      this->cachedTail_.value = 
+        tail_.value.load(std::memory_order_acquire);
+      if(head == cachedTail_.value)
+        return false;
+    }
+    T* p = this->slot(head);
+    out = H::cxpr_move(*p);
+    X11::destruct(p);
+    this->head_.value.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Moves up to `out.size()` elements into `out`, 
+  /// releasing their slots at once. Returns the number popped.
+  size_type tryPopBatch(ArrayRef<T> out) {
+    const size_type head = head_.value.load(std::memory_order_relaxed);
+    size_type avail = cachedTail_.value - head;
+    if(avail < out.size_) {
+      this->cachedTail_.value = 
+        tail_.value.load(std::memory_order_acquire);
+      avail = cachedTail_.value - head;
+    }
+    const size_type n = (out.size_ < avail) ? out.size_ : avail;
+    for(size_type I = 0; I < n; ++I) {
+      T* p = this->slot(head + I);
+      out.data_[I] = H::cxpr_move(*p);
+      X11::destruct(p);
+    }
+    if(n)
+      this->head_.value.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+  /// Returns the front element, or null if empty.
+  /// Only valid until the next pop.
+  T* front() {
+    const size_type head = head_.value.load(std::memory_order_relaxed);
+    if(head == cachedTail_.value) {
+      this->cachedTail_.value = 
+        tail_.value.load(std::memory_order_acquire);
+      if(head == cachedTail_.value)
+        return nullptr;
+    }
+    return this->slot(head);
+  }
+
+  //=== Observers ===//
+
+  size_type capacity() const NOEXCEPT { return capacity_; }
+
+  /// The number of elements, may be stale when called
+  /// from a thread other than the producer or consumer.
+  size_type sizeApprox() const NOEXCEPT {
+    const size_type head = head_.value.load(std::memory_order_acquire);
+    const size_type tail = tail_.value.load(std::memory_order_acquire);
+    return tail - head;
+  }
+
+  bool isEmptyApprox() const NOEXCEPT {
+    return this->sizeApprox() == 0;
+  }
+
+private:
+  ALWAYS_INLINE T* slot(size_type I) const NOEXCEPT {
+    return data_ + (I & (capacity_ - 1));
+  }
+
+private:
+  const size_type capacity_;
+  T* const data_;
+  /// Written by the consumer.
+  H::CachePadded<H::QueueAtomic<size_type>> head_ { };
+  /// Consumer's view of `tail_`.
+  H::CachePadded<size_type> cachedTail_ { 0 };
+  /// Written by the producer.
+  H::CachePadded<H::QueueAtomic<size_type>> tail_ { };
+  /// Producer's view of `head_`.
+  H::CachePadded<size_type> cachedHead_ { 0 };
+};
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_SPSCQUEUE_HPP
@@ -0,0 +1,241 @@
+//===- Core/StrInterner.hpp -----------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file defines StrInterner, which maps strings to 32-bit
+//  Symbols. Strings are stored once in an arena, and never freed.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_STRINTERNER_HPP
+#define EFL_CORE_STRINTERNER_HPP
+
+#include <atomic>
+#include "Traits.hpp"
+#include "Arena.hpp"
+#include "Bits.hpp"
+#include "FlatMap.hpp"
+#include "Mtx.hpp"
+#include "Option.hpp"
+#include "StrRef.hpp"
+
+namespace efl {
+namespace C {
+
+/**
+ * @brief Handle to a string in a `StrInterner`.
+ * 
+ * Equal symbols from the same interner refer to equal strings,
+ * so comparisons are a single integer compare. The default
+ * symbol is the empty string, which every interner contains.
+ */
+struct Symbol {
+  constexpr Symbol() = default;
+  explicit constexpr Symbol(u32 id) NOEXCEPT : id_(id) { }
+
+  /// The index of the symbol in its interner.
+  FICONSTEXPR u32 id() const NOEXCEPT { return id_; }
+  /// Checks if this is the empty string.
+  FICONSTEXPR bool isEmpty() const NOEXCEPT { return id_ == 0; }
+
+  friend constexpr bool operator==(Symbol l, Symbol r) NOEXCEPT {
+    return l.id_ == r.id_;
+  }
+
+#if CPPVER_MOST(17)
+  friend constexpr bool operator!=(Symbol l, Symbol r) NOEXCEPT {
+    return l.id_ != r.id_;
+  }
+#endif // Three-way Comparison Check (C++20)
+
+  /// Orders by interning time, NOT lexicographically.
+  friend constexpr bool operator<(Symbol l, Symbol r) NOEXCEPT {
+    return l.id_ < r.id_;
+  }
+
+public:
+  u32 id_ = 0;
+};
+
+template <>
+struct Hash<Symbol> : H::HashBase {
+  using H::HashBase::HashBase;
+  ALWAYS_INLINE EFLI_CXX14_CXPR_ usize 
+   operator()(Symbol sym) const NOEXCEPT {
+    return usize(H::hash_int(sym.id_, seed_));
+  }
+};
+
+namespace H {
+  /**
+   * @brief Maps symbol ids to their strings.
+   * 
+   * Entries live in buckets which double in size, so existing
+   * entries never move, and lookups don't need a lock. Writers
+   * must hold ids which are unique to them.
+   */
+  struct SymbolTable {
+    using size_type = H::SzType;
+    /// Bucket 0 holds `1 << baseShift` entries.
+    static constexpr u32 baseShift = 8;
+    static constexpr u32 maxBuckets = 32 - baseShift + 1;
+  public:
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+    ~SymbolTable();
+
+    /// Returns the string stored for `id`.
+    ALWAYS_INLINE StrRef get(u32 id) const NOEXCEPT {
+      const u64 v = u64(id) + (u64(1) << baseShift);
+      const u32 B = u32(bit_width(v)) - (baseShift + 1);
+      const StrRef* bucket = buckets_[B].load(std::memory_order_acquire);
+      EFLI_DBGASSERT_(bucket != nullptr);
+      return bucket[v - (u64(1) << (B + baseShift))];
+    }
+
+    /// Stores `str` at `id`, allocating the bucket if needed.
+    void set(u32 id, StrRef str);
+
+  private:
+    StrRef* allocateBucket(u32 B);
+
+  private:
+    std::atomic<StrRef*> buckets_[maxBuckets] { };
+  };
+} // namespace H
+
+//=== StrInterner ===//
+
+/**
+ * @brief Deduplicates strings into compact `Symbol`s.
+ * 
+ * Interned strings are copied into an arena, null terminated,
+ * and stay valid until the interner is destroyed. Not thread-safe,
+ * see `SyncStrInterner`.
+ */
+struct StrInterner {
+  using size_type = H::SzType;
+public:
+  /// Interns the empty string as `Symbol()`.
+  StrInterner();
+  StrInterner(const StrInterner&) = delete;
+  StrInterner& operator=(const StrInterner&) = delete;
+
+  /// Returns the symbol for `str`, adding it if it doesn't exist.
+  Symbol intern(StrRef str);
+
+  /// Returns the symbol for `str` if it was interned.
+  Option<Symbol> find(StrRef str) const;
+
+  /// Checks if `str` has been interned.
+  bool contains(StrRef str) const {
+    return map_.contains(str);
+  }
+
+  /// Returns the string for `sym`, in O(1).
+  ALWAYS_INLINE StrRef str(Symbol sym) const NOEXCEPT {
+    EFLI_DBGASSERT_(sym.id_ < size_);
+    return table_.get(sym.id_);
+  }
+
+  ALWAYS_INLINE StrRef operator[](Symbol sym) const NOEXCEPT {
+    return this->str(sym);
+  }
+
+  /// The number of unique strings, including the empty string.
+  size_type size() const NOEXCEPT { return size_; }
+
+private:
+  Arena arena_;
+  FlatMap<StrRef, u32> map_;
+  H::SymbolTable table_;
+  u32 size_ = 0;
+};
+
+//=== SyncStrInterner ===//
+
+/**
+ * @brief Thread-safe version of `StrInterner`.
+ * 
+ * Strings are split across shards by hash, each with its own lock,
+ * arena, and map. `str(...)` never locks. Symbols are compatible
+ * with other symbols from the same interner only.
+ */
+struct SyncStrInterner {
+  using size_type = H::SzType;
+  static constexpr u32 shardBits = 4;
+  static constexpr u32 shardCount = 1U << shardBits;
+public:
+  /// Interns the empty string as `Symbol()`.
+  SyncStrInterner();
+  SyncStrInterner(const SyncStrInterner&) = delete;
+  SyncStrInterner& operator=(const SyncStrInterner&) = delete;
+
+  /// Returns the symbol for `str`, adding it if it doesn't exist.
+  Symbol intern(StrRef str);
+
+  /// Returns the symbol for `str` if it was interned.
+  Option<Symbol> find(StrRef str);
+
+  /// Checks if `str` has been interned.
+  bool contains(StrRef str) {
+    return this->find(str).hasValue();
+  }
+
+  /// Returns the string for `sym`, in O(1).
+  /// `sym` must have been passed to this thread with proper
+  /// synchronization, eg. through a queue or a lock.
+  ALWAYS_INLINE StrRef str(Symbol sym) const NOEXCEPT {
+    return table_.get(sym.id_);
+  }
+
+  ALWAYS_INLINE StrRef operator[](Symbol sym) const NOEXCEPT {
+    return this->str(sym);
+  }
+
+  /// The number of unique strings, including the empty string.
+  size_type size() const NOEXCEPT {
+    return next_id_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct alignas(64) Shard {
+#if EFL_MULTITHREADED
+    Mtx mtx_;
+#endif
+    Arena arena_;
+    FlatMap<StrRef, u32> map_;
+  };
+
+  Shard& shardFor(usize hash) NOEXCEPT {
+    // The high bits aren't used by the shard maps.
+    return shards_[hash >> (sizeof(usize) * 8 - shardBits)];
+  }
+
+private:
+  Shard shards_[shardCount];
+  H::SymbolTable table_;
+  std::atomic<u32> next_id_ { 0 };
+};
+
+} // namespace C
+} // namespace efl
+
+#endif // EFL_CORE_STRINTERNER_HPP
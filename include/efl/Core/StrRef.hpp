@@ -29,13 +29,13 @@
 #include <algorithm>
 #include <cstring>
 #include <iterator>
-#if CPPVER_LEAST(17)
-# include <string_view>
-#endif
 #include "Str.hpp"
 #include "Traits.hpp"
 #include "_Cxx11Assert.hpp"
 #include "_Version.hpp"
+#if CPPVER_LEAST(17)
+# include <string_view>
+#endif
 
 EFLI_CXPR11ASSERT_PROLOGUE_
 
@@ -53,10 +53,105 @@ EFLI_CXPR11ASSERT_PROLOGUE_
   std::char_traits<char>::length(s)
 #endif
 
-// TODO: Finish implementation (consume, parse, search functions)
+// TODO: Finish implementation (parse functions)
 
 namespace efl {
 namespace C {
+namespace H {
+  /// Checks if `c` is in a `CharSet` table.
+  FICONSTEXPR bool charset_has(const u8* table, char c) NOEXCEPT {
+    return (table[((u8(c) >> 7) << 4) | (u8(c) & 0xF)]
+      >> ((u8(c) >> 4) & 0x7)) & 1;
+  }
+
+  //=== Scalar Search ===//
+
+  EFLI_CXX14_CXPR_ SzType cxpr_find_char(
+   const char* s, SzType n, char c) NOEXCEPT {
+    for(SzType I = 0; I < n; ++I) {
+      if(s[I] == c) return I;
+    }
+    return ~SzType(0);
+  }
+
+  EFLI_CXX14_CXPR_ SzType cxpr_rfind_char(
+   const char* s, SzType n, char c) NOEXCEPT {
+    for(SzType I = n; I > 0; --I) {
+      if(s[I - 1] == c) return I - 1;
+    }
+    return ~SzType(0);
+  }
+
+  EFLI_CXX14_CXPR_ bool cxpr_match(
+   const char* l, const char* r, SzType n) NOEXCEPT {
+    for(SzType I = 0; I < n; ++I) {
+      if(l[I] != r[I]) return false;
+    }
+    return true;
+  }
+
+  /// Naive search, `k` must be nonzero.
+  EFLI_CXX14_CXPR_ SzType cxpr_find(const char* s, 
+   SzType n, const char* t, SzType k) NOEXCEPT {
+    for(SzType I = 0; I + k <= n; ++I) {
+      if(s[I] == t[0] && cxpr_match(s + I, t, k))
+        return I;
+    }
+    return ~SzType(0);
+  }
+
+  /// Naive reverse search, `k` must be nonzero.
+  EFLI_CXX14_CXPR_ SzType cxpr_rfind(const char* s, 
+   SzType n, const char* t, SzType k) NOEXCEPT {
+    for(SzType I = n - k + 1; k <= n && I > 0; --I) {
+      if(s[I - 1] == t[0] && cxpr_match(s + I - 1, t, k))
+        return I - 1;
+    }
+    return ~SzType(0);
+  }
+
+  /// First character in the table, or `npos`.
+  EFLI_CXX14_CXPR_ SzType cxpr_find_of(
+   const char* s, SzType n, const u8* table) NOEXCEPT {
+    for(SzType I = 0; I < n; ++I) {
+      if(charset_has(table, s[I])) return I;
+    }
+    return ~SzType(0);
+  }
+
+  EFLI_CXX14_CXPR_ SzType cxpr_count_char(
+   const char* s, SzType n, char c) NOEXCEPT {
+    SzType count = 0;
+    for(SzType I = 0; I < n; ++I)
+      count += (s[I] == c);
+    return count;
+  }
+
+  //=== Vectorized Search ===//
+  // Defined in StrSearch.cpp. Offsets are relative to `s`,
+  // and misses return `npos`. Needles must be nonempty.
+
+  SzType str_find_char(const char* s, SzType n, char c) NOEXCEPT;
+  SzType str_rfind_char(const char* s, SzType n, char c) NOEXCEPT;
+  SzType str_find(const char* s, SzType n,
+    const char* t, SzType k) NOEXCEPT;
+  SzType str_rfind(const char* s, SzType n,
+    const char* t, SzType k) NOEXCEPT;
+  SzType str_find_of(const char* s, SzType n,
+    const u8* table) NOEXCEPT;
+  SzType str_count_char(const char* s, SzType n, char c) NOEXCEPT;
+} // namespace H
+
+struct CharSet;
+template <typename Finder> struct StrSplitRange;
+
+namespace H {
+  struct SplitChar;
+  struct SplitStr;
+  struct SplitAny;
+  struct SplitLines;
+} // namespace H
+
 /**
  * @brief Non-owning view over a constant string.
  * 
@@ -88,7 +183,7 @@ private:
 #if CPPVER_LEAST(20)
     if(EFL_RT_CXPREVAL()) UNLIKELY {
       if(len == 0) return 0;
-      return std::equal(l, l + len, r); 
+      return !std::equal(l, l + len, r); 
     }
 #endif // C++20 Check
     return !!StrRef::Memcmp(l, r, len);
@@ -200,7 +295,7 @@ public:
   /// Check if two strings are equal.
   EFLI_CXX20_CXPR_ bool isEqual(StrRef str) const {
     if(size_ != str.size_) return false;
-    return StrRef::CxprMemcmp(
+    return !StrRef::CxprMemcmp(
       begin(), str.begin(), size_);
   }
 
@@ -293,7 +388,205 @@ public:
     return dropFront(size_ - n);
   }
 
-  // find, findSlow (cxpr) [and associated functions]
+  //=== Search ===//
+
+  /// Index of the first `c` at or after `pos`, or `npos`.
+  NODISCARD EFLI_CXX20_CXPR_ size_type 
+   find(char c, size_type pos = 0) const NOEXCEPT {
+    if(pos >= size_) return npos;
+#if CPPVER_LEAST(20)
+    if(EFL_RT_CXPREVAL())
+      return this->findSlow(c, pos);
+#endif // C++20 Check
+    return Offset(H::str_find_char(
+      data_ + pos, size_ - pos, c), pos);
+  }
+
+  /// Index of the first `str` at or after `pos`, or `npos`.
+  /// Filters candidates on the first and last characters.
+  NODISCARD EFLI_CXX20_CXPR_ size_type 
+   find(StrRef str, size_type pos = 0) const NOEXCEPT {
+    if(str.size_ == 0) 
+      return (pos <= size_) ? pos : npos;
+    if(pos >= size_ || str.size_ > size_ - pos)
+      return npos;
+#if CPPVER_LEAST(20)
+    if(EFL_RT_CXPREVAL())
+      return this->findSlow(str, pos);
+#endif // C++20 Check
+    return Offset(H::str_find(data_ + pos, 
+      size_ - pos, str.data_, str.size_), pos);
+  }
+
+  /// Index of the last `c` at or before `pos`, or `npos`.
+  NODISCARD EFLI_CXX20_CXPR_ size_type 
+   rfind(char c, size_type pos = npos) const NOEXCEPT {
+    const size_type n = (pos < size_) ? pos + 1 : size_;
+#if CPPVER_LEAST(20)
+    if(EFL_RT_CXPREVAL())
+      return H::cxpr_rfind_char(data_, n, c);
+#endif // C++20 Check
+    return H::str_rfind_char(data_, n, c);
+  }
+
+  /// Index of the last `str` starting at or before `pos`, or `npos`.
+  NODISCARD EFLI_CXX20_CXPR_ size_type 
+   rfind(StrRef str, size_type pos = npos) const NOEXCEPT {
+    if(str.size_ > size_) return npos;
+    const size_type last = size_ - str.size_;
+    const size_type start = (pos < last) ? pos : last;
+    if(str.size_ == 0) return start;
+#if CPPVER_LEAST(20)
+    if(EFL_RT_CXPREVAL())
+      return H::cxpr_rfind(data_, 
+        start + str.size_, str.data_, str.size_);
+#endif // C++20 Check
+    return H::str_rfind(data_, 
+      start + str.size_, str.data_, str.size_);
+  }
+
+  /// Index of the first character in `set` at or after `pos`.
+  NODISCARD EFLI_CXX20_CXPR_ size_type 
+   findFirstOf(const CharSet& set, size_type pos = 0) const NOEXCEPT;
+
+  /// Index of the first character not in `set` at or after `pos`.
+  NODISCARD EFLI_CXX20_CXPR_ size_type 
+   findFirstNotOf(const CharSet& set, size_type pos = 0) const NOEXCEPT;
+
+  /// Index of the first character in `chars` at or after `pos`.
+  NODISCARD EFLI_CXX20_CXPR_ size_type 
+   findFirstOf(StrRef chars, size_type pos = 0) const NOEXCEPT;
+
+  /// Index of the first character not in `chars` at or after `pos`.
+  NODISCARD EFLI_CXX20_CXPR_ size_type 
+   findFirstNotOf(StrRef chars, size_type pos = 0) const NOEXCEPT;
+
+  /// Number of occurrences of `c`.
+  NODISCARD EFLI_CXX20_CXPR_ size_type count(char c) const NOEXCEPT {
+#if CPPVER_LEAST(20)
+    if(EFL_RT_CXPREVAL())
+      return H::cxpr_count_char(data_, size_, c);
+#endif // C++20 Check
+    return H::str_count_char(data_, size_, c);
+  }
+
+  /// Number of non-overlapping occurrences of `str`.
+  /// Empty needles are never counted.
+  NODISCARD EFLI_CXX20_CXPR_ size_type 
+   count(StrRef str) const NOEXCEPT {
+    if(str.size_ == 0) return 0;
+    size_type total = 0;
+    size_type pos = this->find(str);
+    while(pos != npos) {
+      ++total;
+      pos = this->find(str, pos + str.size_);
+    }
+    return total;
+  }
+
+  /// Checks if `c` is in the string.
+  NODISCARD EFLI_CXX20_CXPR_ bool contains(char c) const NOEXCEPT {
+    return this->find(c) != npos;
+  }
+
+  /// Checks if `str` is in the string.
+  NODISCARD EFLI_CXX20_CXPR_ bool contains(StrRef str) const NOEXCEPT {
+    return this->find(str) != npos;
+  }
+
+  /// Scalar `find(char)`, usable in constant expressions.
+  NODISCARD EFLI_CXX14_CXPR_ size_type 
+   findSlow(char c, size_type pos = 0) const NOEXCEPT {
+    if(pos >= size_) return npos;
+    return Offset(H::cxpr_find_char(
+      data_ + pos, size_ - pos, c), pos);
+  }
+
+  /// Scalar `find(StrRef)`, usable in constant expressions.
+  NODISCARD EFLI_CXX14_CXPR_ size_type 
+   findSlow(StrRef str, size_type pos = 0) const NOEXCEPT {
+    if(str.size_ == 0) 
+      return (pos <= size_) ? pos : npos;
+    if(pos >= size_ || str.size_ > size_ - pos)
+      return npos;
+    return Offset(H::cxpr_find(data_ + pos, 
+      size_ - pos, str.data_, str.size_), pos);
+  }
+
+  /// Checks if the string starts with `str`.
+  NODISCARD EFLI_CXX20_CXPR_ bool 
+   startsWith(StrRef str) const NOEXCEPT {
+    return (str.size_ <= size_) && 
+      !StrRef::CxprMemcmp(data_, str.data_, str.size_);
+  }
+
+  /// Checks if the string ends with `str`.
+  NODISCARD EFLI_CXX20_CXPR_ bool 
+   endsWith(StrRef str) const NOEXCEPT {
+    return (str.size_ <= size_) && !StrRef::CxprMemcmp(
+      data_ + (size_ - str.size_), str.data_, str.size_);
+  }
+
+  //=== Consuming ===//
+
+  /// Removes `str` from the start of the string, if it's there.
+  EFLI_CXX20_CXPR_ bool consumeFront(StrRef str) NOEXCEPT {
+    if(!this->startsWith(str)) return false;
+    this->removePrefix(str.size_);
+    return true;
+  }
+
+  /// Removes `str` from the end of the string, if it's there.
+  EFLI_CXX20_CXPR_ bool consumeBack(StrRef str) NOEXCEPT {
+    if(!this->endsWith(str)) return false;
+    this->removeSuffix(str.size_);
+    return true;
+  }
+
+  /// Removes and returns everything before the first `c`,
+  /// dropping the `c`. Consumes the whole string if not found.
+  EFLI_CXX20_CXPR_ StrRef consumeUntil(char c) NOEXCEPT {
+    return this->consumeAt(this->find(c), 1);
+  }
+
+  /// Removes and returns everything before the first `sep`,
+  /// dropping the `sep`. Consumes the whole string if not found.
+  EFLI_CXX20_CXPR_ StrRef consumeUntil(StrRef sep) NOEXCEPT {
+    return this->consumeAt(this->find(sep), sep.size_);
+  }
+
+  /// Removes and returns everything before the first character
+  /// in `set`, dropping that character.
+  EFLI_CXX20_CXPR_ StrRef consumeUntilAny(const CharSet& set) NOEXCEPT;
+
+  /// Removes and returns the leading run of characters in `set`.
+  EFLI_CXX20_CXPR_ StrRef consumeWhile(const CharSet& set) NOEXCEPT;
+
+  /// Removes and returns the first line, without its `\n` or `\r\n`.
+  EFLI_CXX20_CXPR_ StrRef consumeLine() NOEXCEPT {
+    StrRef line = this->consumeUntil('\n');
+    if(!line.isEmpty() && line.back() == '\r')
+      line.removeSuffix(1);
+    return line;
+  }
+
+  //=== Splitting ===//
+  // Ranges are lazy and never allocate. `n` separators give
+  // `n + 1` pieces, so empty pieces are kept.
+
+  /// Splits the string on every `c`.
+  NODISCARD StrSplitRange<H::SplitChar> split(char c) const NOEXCEPT;
+
+  /// Splits the string on every `sep`, which must not be empty.
+  NODISCARD StrSplitRange<H::SplitStr> split(StrRef sep) const NOEXCEPT;
+
+  /// Splits the string on every character in `set`.
+  NODISCARD StrSplitRange<H::SplitAny> 
+   splitAny(const CharSet& set) const NOEXCEPT;
+
+  /// Splits the string into lines, stripping `\r\n` endings.
+  /// A trailing newline doesn't start another line.
+  NODISCARD StrSplitRange<H::SplitLines> lines() const NOEXCEPT;
 
   /// Copy contents of `StrRef` to a new `Str`.
   HINT_INLINE Str toStr() const { 
@@ -310,14 +603,142 @@ public:
   /// Implicitly create new `Str` from `StrRef`.
   operator Str() const { return this->toStr(); }
 
+  friend EFLI_CXX20_CXPR_ bool operator==(
+   StrRef l, StrRef r) NOEXCEPT {
+    return l.isEqual(r);
+  }
+
+#if CPPVER_MOST(17)
+  friend EFLI_CXX20_CXPR_ bool operator!=(
+   StrRef l, StrRef r) NOEXCEPT {
+    return !l.isEqual(r);
+  }
+#endif // Three-way Comparison Check (C++20)
+
+private:
+  FICONSTEXPR static size_type 
+   Offset(size_type n, size_type pos) NOEXCEPT {
+    return (n == npos) ? npos : n + pos;
+  }
+
+  /// Splits at `pos`, dropping `n` characters after it.
+  EFLI_CXX14_CXPR_ StrRef 
+   consumeAt(size_type pos, size_type n) NOEXCEPT {
+    if(pos == npos) {
+      const StrRef all = *this;
+      this->data_ += size_;
+      this->size_ = 0;
+      return all;
+    }
+    const StrRef front(data_, pos);
+    this->data_ += (pos + n);
+    this->size_ -= (pos + n);
+    return front;
+  }
+
 public:
   const char* data_ = nullptr;
   size_type   size_ = 0;
 };
 
+/**
+ * @brief Set of bytes, for `StrRef::findFirstOf` and friends.
+ * 
+ * Stored as a bitmap transposed by nibble: the byte `c` is bit
+ * `(c >> 4) & 7` of `table_[(c >> 7) * 16 + (c & 15)]`. Vector
+ * kernels can then test 32 bytes with a few shuffles.
+ */
+struct CharSet {
+  constexpr CharSet() = default;
+
+  /// Constructs from every character in `chars`.
+  EFLI_CXX14_CXPR_ CharSet(StrRef chars) NOEXCEPT {
+    for(char c : chars)
+      this->insert(c);
+  }
+
+  /// Set with every byte in `[lo, hi]`.
+  NODISCARD EFLI_CXX14_CXPR_ static CharSet 
+   Range(char lo, char hi) NOEXCEPT {
+    CharSet set {};
+    for(u32 c = u8(lo); c <= u8(hi); ++c)
+      set.insert(char(c));
+    return set;
+  }
+
+  NODISCARD constexpr bool contains(char c) const NOEXCEPT {
+    return H::charset_has(table_, c);
+  }
+
+  EFLI_CXX14_CXPR_ CharSet& insert(char c) NOEXCEPT {
+    this->table_[((u8(c) >> 7) << 4) | (u8(c) & 0xF)] 
+      |= u8(1U << ((u8(c) >> 4) & 0x7));
+    return *this;
+  }
+
+  EFLI_CXX14_CXPR_ CharSet& operator|=(const CharSet& r) NOEXCEPT {
+    for(H::SzType I = 0; I < 32; ++I)
+      this->table_[I] |= r.table_[I];
+    return *this;
+  }
+
+  /// Set with every byte not in `*this`.
+  NODISCARD EFLI_CXX14_CXPR_ CharSet operator~() const NOEXCEPT {
+    CharSet set {};
+    for(H::SzType I = 0; I < 32; ++I)
+      set.table_[I] = u8(~table_[I]);
+    return set;
+  }
+
+public:
+  u8 table_[32] { };
+};
+
+//=== Search (CharSet) ===//
+
+inline EFLI_CXX20_CXPR_ StrRef::size_type StrRef::findFirstOf(
+ const CharSet& set, size_type pos) const NOEXCEPT {
+  if(pos >= size_) return npos;
+#if CPPVER_LEAST(20)
+  if(EFL_RT_CXPREVAL())
+    return Offset(H::cxpr_find_of(
+      data_ + pos, size_ - pos, set.table_), pos);
+#endif // C++20 Check
+  return Offset(H::str_find_of(
+    data_ + pos, size_ - pos, set.table_), pos);
+}
+
+inline EFLI_CXX20_CXPR_ StrRef::size_type StrRef::findFirstNotOf(
+ const CharSet& set, size_type pos) const NOEXCEPT {
+  return this->findFirstOf(~set, pos);
+}
+
+inline EFLI_CXX20_CXPR_ StrRef::size_type StrRef::findFirstOf(
+ StrRef chars, size_type pos) const NOEXCEPT {
+  return this->findFirstOf(CharSet(chars), pos);
+}
+
+inline EFLI_CXX20_CXPR_ StrRef::size_type StrRef::findFirstNotOf(
+ StrRef chars, size_type pos) const NOEXCEPT {
+  return this->findFirstOf(~CharSet(chars), pos);
+}
+
+inline EFLI_CXX20_CXPR_ StrRef 
+ StrRef::consumeUntilAny(const CharSet& set) NOEXCEPT {
+  return this->consumeAt(this->findFirstOf(set), 1);
+}
+
+inline EFLI_CXX20_CXPR_ StrRef 
+ StrRef::consumeWhile(const CharSet& set) NOEXCEPT {
+  const size_type n = this->findFirstOf(~set);
+  return this->consumeAt((n == npos) ? size_ : n, 0);
+}
+
 } // namespace C
 } // namespace efl
 
+#include "StrRef/Split.hpp"
+
 #undef EFLI_CXPR_STRLEN_
 #undef EFLI_STRLEN_
 
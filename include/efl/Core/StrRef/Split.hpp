@@ -0,0 +1,247 @@
+//===- Core/StrRef/Split.hpp ----------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file implements the lazy split ranges returned by
+//  StrRef::split, splitAny and lines.
+//
+//===----------------------------------------------------------------===//
+
+#pragma once
+
+#ifndef EFL_CORE_STRREF_SPLIT_HPP
+#define EFL_CORE_STRREF_SPLIT_HPP
+
+#include <iterator>
+#include <efl/Core/ArrayRef.hpp>
+#include <efl/Core/SmallVec.hpp>
+
+EFLI_CXPR11ASSERT_PROLOGUE_
+
+namespace efl {
+namespace C {
+namespace H {
+  /// Where a separator was found, and how long it is.
+  struct SplitMatch {
+    SzType pos;
+    SzType size;
+  };
+
+  struct SplitChar {
+    static constexpr bool isLines = false;
+    EFLI_CXX20_CXPR_ SplitMatch find(StrRef str) const NOEXCEPT {
+      return { str.find(c_), 1 };
+    }
+  public:
+    char c_;
+  };
+
+  struct SplitStr {
+    static constexpr bool isLines = false;
+    EFLI_CXX20_CXPR_ SplitMatch find(StrRef str) const NOEXCEPT {
+      return { str.find(sep_), sep_.size() };
+    }
+  public:
+    StrRef sep_;
+  };
+
+  struct SplitAny {
+    static constexpr bool isLines = false;
+    EFLI_CXX20_CXPR_ SplitMatch find(StrRef str) const NOEXCEPT {
+      return { str.findFirstOf(set_), 1 };
+    }
+  public:
+    CharSet set_;
+  };
+
+  /// Splits on `\n`, and trims a `\r` from each line.
+  struct SplitLines {
+    static constexpr bool isLines = true;
+    EFLI_CXX20_CXPR_ SplitMatch find(StrRef str) const NOEXCEPT {
+      return { str.find('\n'), 1 };
+    }
+  };
+
+  template <typename Finder>
+  struct StrSplitIter {
+    using value_type = StrRef;
+    using difference_type = std::ptrdiff_t;
+    using reference = const StrRef&;
+    using pointer = const StrRef*;
+    using iterator_category = std::forward_iterator_tag;
+  public:
+    /// The end iterator.
+    StrSplitIter() = default;
+
+    EFLI_CXX20_CXPR_ StrSplitIter(
+     StrRef str, const Finder& finder) NOEXCEPT
+     : rest_(str), finder_(finder), 
+     more_(!Finder::isLines || !str.isEmpty()), end_(false) {
+      this->advance();
+    }
+
+    reference operator*() const NOEXCEPT { return cur_; }
+    pointer operator->() const NOEXCEPT { return &cur_; }
+
+    EFLI_CXX20_CXPR_ StrSplitIter& operator++() NOEXCEPT {
+      this->advance();
+      return *this;
+    }
+
+    EFLI_CXX20_CXPR_ StrSplitIter operator++(int) NOEXCEPT {
+      StrSplitIter it = *this;
+      this->advance();
+      return it;
+    }
+
+    /// The unsplit text after the current piece.
+    FICONSTEXPR StrRef rest() const NOEXCEPT { return rest_; }
+    /// Checks if the current piece is the last one.
+    FICONSTEXPR bool isLast() const NOEXCEPT { return !more_; }
+
+    friend constexpr bool operator==(
+     const StrSplitIter& l, const StrSplitIter& r) NOEXCEPT {
+      return (l.end_ == r.end_) && (l.end_ || 
+        (l.cur_.data_ == r.cur_.data_ && l.more_ == r.more_));
+    }
+
+    friend constexpr bool operator!=(
+     const StrSplitIter& l, const StrSplitIter& r) NOEXCEPT {
+      return !(l == r);
+    }
+
+  private:
+    EFLI_CXX20_CXPR_ void advance() NOEXCEPT {
+      if(!more_) {
+        this->end_ = true;
+        return;
+      }
+      const SplitMatch m = finder_.find(rest_);
+      if(m.pos == StrRef::npos) {
+        this->cur_ = rest_;
+        this->rest_ = StrRef(rest_.end(), 0);
+        this->more_ = false;
+      } else {
+        this->cur_ = StrRef(rest_.data_, m.pos);
+        this->rest_ = rest_.dropFront(m.pos + m.size);
+        // A trailing newline doesn't start a new line.
+        if(Finder::isLines && rest_.isEmpty())
+          this->more_ = false;
+      }
+      if(Finder::isLines && !cur_.isEmpty() && cur_.back() == '\r')
+        this->cur_.removeSuffix(1);
+    }
+
+  private:
+    StrRef cur_;
+    StrRef rest_;
+    Finder finder_ { };
+    bool more_ = false;
+    bool end_ = true;
+  };
+} // namespace H
+
+/**
+ * @name StrSplitRange
+ * @brief Lazy forward range over the pieces of a `StrRef`.
+ * 
+ * Pieces point into the original string, so nothing is copied
+ * or allocated. Use `collect` or `fill` for random access.
+ */
+template <typename Finder>
+struct StrSplitRange {
+  using iterator = H::StrSplitIter<Finder>;
+  using const_iterator = iterator;
+  using value_type = StrRef;
+  using size_type = H::SzType;
+public:
+  EFLI_CXX20_CXPR_ iterator begin() const NOEXCEPT
+  { return iterator(str_, finder_); }
+
+  EFLI_CXX20_CXPR_ iterator end() const NOEXCEPT
+  { return iterator(); }
+
+  /// Appends every piece to `out`, returns how many were added.
+  size_type collect(SmallVecImpl<StrRef>& out) const {
+    size_type n = 0;
+    for(StrRef piece : *this) {
+      out.push_back(piece);
+      ++n;
+    }
+    return n;
+  }
+
+  /// Writes up to `out.size()` pieces, returns how many were 
+  /// written. If there are more, the last slot holds the 
+  /// unsplit remainder, so no text is dropped.
+  EFLI_CXX20_CXPR_ size_type 
+   fill(ArrayRef<StrRef> out) const NOEXCEPT {
+    if(out.size() == 0) return 0;
+    size_type n = 0;
+    for(iterator it = this->begin(); it != this->end(); ++it) {
+      if(n + 1 == out.size() && !it.isLast()) {
+        out[n++] = StrRef(it->data_, 
+          size_type(str_.end() - it->data_));
+        break;
+      }
+      out[n++] = *it;
+    }
+    return n;
+  }
+
+  /// Number of pieces, in one pass.
+  NODISCARD EFLI_CXX20_CXPR_ size_type count() const NOEXCEPT {
+    size_type n = 0;
+    for(iterator it = this->begin(); it != this->end(); ++it)
+      ++n;
+    return n;
+  }
+
+public:
+  StrRef str_;
+  Finder finder_;
+};
+
+//=== StrRef Splitting ===//
+
+inline StrSplitRange<H::SplitChar> 
+ StrRef::split(char c) const NOEXCEPT {
+  return { *this, H::SplitChar { c } };
+}
+
+inline StrSplitRange<H::SplitStr> 
+ StrRef::split(StrRef sep) const NOEXCEPT {
+  EFLI_DBGASSERT_(!sep.isEmpty());
+  return { *this, H::SplitStr { sep } };
+}
+
+inline StrSplitRange<H::SplitAny> 
+ StrRef::splitAny(const CharSet& set) const NOEXCEPT {
+  return { *this, H::SplitAny { set } };
+}
+
+inline StrSplitRange<H::SplitLines> 
+ StrRef::lines() const NOEXCEPT {
+  return { *this, H::SplitLines { } };
+}
+
+} // namespace C
+} // namespace efl
+
+EFLI_CXPR11ASSERT_EPILOGUE_
+
+#endif // EFL_CORE_STRREF_SPLIT_HPP
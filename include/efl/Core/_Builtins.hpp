@@ -42,9 +42,9 @@
 /// For use inside statements, assume false.
 #define EFL_UNLIKELY(...) EFLI_EXPECT_FALSE_((__VA_ARGS__))
 /// For a less aggressive assumption.
-#define EFL_SOFT_LIKELY(...) EFLI_SOFT_TEXPECT_(bool, (__VA_ARGS__), true)
+#define EFL_SOFT_LIKELY(...) EFLI_SOFT_TEXPECT_(bool, true, (__VA_ARGS__))
 /// For a less aggressive assumption.
-#define EFL_SOFT_UNLIKELY(...) EFLI_SOFT_TEXPECT_(bool, (__VA_ARGS__), false)
+#define EFL_SOFT_UNLIKELY(...) EFLI_SOFT_TEXPECT_(bool, false, (__VA_ARGS__))
 /// Marks code as unlikely to be executed.
 #define EFL_COLD_PATH EFLI_COLD_PATH_
 /// Unlikely at runtime. May help optimize.
@@ -25,11 +25,9 @@
 
 #include <CoreCommon/ConfigCache.hpp>
 
-// TODO: Implement wyhash
-
 namespace efl {
 namespace C {
-/// Faster hash implementation.
+/// Faster hash implementation, see `Hash.hpp`.
 template <typename T, typename = void>
 struct Hash {
   COMPILE_FAILURE(T, 
@@ -0,0 +1,101 @@
+//===- AllocStats.cpp -----------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+
+#include <CoreCommon/Mimalloc.hpp>
+#include <Core/AllocStats.hpp>
+#include <Core/Mtx.hpp>
+
+#if EFL_MULTITHREADED
+# define STATS_LOCK_() MEflLock(registry_mtx_)
+#else
+# define STATS_LOCK_() (void)(0)
+#endif
+
+using namespace efl;
+using namespace efl::C;
+
+namespace {
+  // Constant initialized, so usable during static init.
+  C::Mtx registry_mtx_ { };
+  H::AllocTagCounters* registry_head_ = nullptr;
+  /// Totals from threads which have exited.
+  AllocTagStats retired_[maxAllocTags] { };
+} // namespace `anonymous`
+
+static void add_counter_(AllocTagStats& out, const H::AllocCounter& in) {
+  out.allocBytes += in.allocBytes.load(std::memory_order_relaxed);
+  out.allocCount += in.allocCount.load(std::memory_order_relaxed);
+  out.freeBytes  += in.freeBytes.load(std::memory_order_relaxed);
+  out.freeCount  += in.freeCount.load(std::memory_order_relaxed);
+}
+
+H::AllocTagCounters::AllocTagCounters() NOEXCEPT {
+  STATS_LOCK_();
+  this->next_ = registry_head_;
+  if(registry_head_)
+    registry_head_->prev_ = this;
+  registry_head_ = this;
+}
+
+H::AllocTagCounters::~AllocTagCounters() {
+  STATS_LOCK_();
+  for(SzType I = 0; I < maxAllocTags; ++I)
+    add_counter_(retired_[I], this->counters_[I]);
+  if(this->prev_)
+    this->prev_->next_ = this->next_;
+  else
+    registry_head_ = this->next_;
+  if(this->next_)
+    this->next_->prev_ = this->prev_;
+}
+
+AllocTagStats C::alloc_tag_stats(AllocTag tag) {
+  const auto idx = H::SzType(tag);
+  $raw_assert(idx < maxAllocTags);
+  STATS_LOCK_();
+  AllocTagStats stats = retired_[idx];
+  for(auto* P = registry_head_; P; P = P->next_)
+    add_counter_(stats, P->counters_[idx]);
+  return stats;
+}
+
+AllocStatsSnapshot C::snapshot_alloc_stats() {
+  AllocStatsSnapshot snapshot { };
+  {
+    STATS_LOCK_();
+    for(H::SzType I = 0; I < maxAllocTags; ++I) {
+      snapshot.tags[I] = retired_[I];
+      for(auto* P = registry_head_; P; P = P->next_)
+        add_counter_(snapshot.tags[I], P->counters_[I]);
+    }
+  }
+
+  // Fold the current thread's stats into the main stats.
+  mi_stats_merge();
+  MimProcessInfo& proc = snapshot.process;
+  mi_process_info(
+    &proc.elapsedMs, &proc.userMs, &proc.systemMs,
+    &proc.currentRss, &proc.peakRss,
+    &proc.currentCommit, &proc.peakCommit,
+    &proc.pageFaults);
+  // `mi_process_info` reads these from the main stats.
+  MimStatsInfo& mi = snapshot.mimalloc;
+  mi.committed.current = i64(proc.currentCommit);
+  mi.committed.peak = i64(proc.peakCommit);
+  return snapshot;
+}
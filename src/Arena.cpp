@@ -0,0 +1,82 @@
+//===- Arena.cpp ----------------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+
+#include <CoreCommon/Mimalloc.hpp>
+#include <Core/Arena.hpp>
+
+using namespace efl;
+using namespace efl::C;
+
+void* Arena::allocateSlow(size_type size, size_type align) {
+  // Leave room for the header and the worst case padding.
+  const size_type needed = sizeof(H::ArenaChunk) + size + align;
+  size_type chunk_size = this->next_size_;
+  if(EFL_UNLIKELY(needed > chunk_size))
+    chunk_size = needed;
+  else if(this->next_size_ < Arena::maxChunkSize)
+    this->next_size_ *= 2;
+  // Use the slack in the size class.
+  chunk_size = mi_good_size(chunk_size);
+
+  auto* chunk = static_cast<H::ArenaChunk*>(mi_malloc(chunk_size));
+  if(EFL_UNLIKELY(!chunk)) return nullptr;
+  chunk->prev = this->chunk_;
+  chunk->size = chunk_size;
+  this->chunk_ = chunk;
+
+  ubyte* p = H::align_ptr(chunk->begin(), align);
+  this->cur_ = p + size;
+  this->end_ = chunk->end();
+  return p;
+}
+
+void Arena::rollback(Marker marker) NOEXCEPT {
+  Arena::FreeChunks(this->chunk_, marker.chunk_);
+  this->chunk_ = marker.chunk_;
+  if(EFL_SOFT_LIKELY(this->chunk_)) {
+    this->cur_ = marker.cur_;
+    this->end_ = this->chunk_->end();
+  } else {
+    this->cur_ = nullptr;
+    this->end_ = nullptr;
+  }
+}
+
+void Arena::reset() NOEXCEPT {
+  if(EFL_UNLIKELY(!this->chunk_)) return;
+  Arena::FreeChunks(this->chunk_->prev, nullptr);
+  this->chunk_->prev = nullptr;
+  this->cur_ = this->chunk_->begin();
+  this->end_ = this->chunk_->end();
+}
+
+Arena::size_type Arena::capacity() const NOEXCEPT {
+  size_type total = 0;
+  for(auto* chunk = this->chunk_; chunk; chunk = chunk->prev)
+    total += chunk->size;
+  return total;
+}
+
+void Arena::FreeChunks(H::ArenaChunk* from, H::ArenaChunk* to) NOEXCEPT {
+  while(from != to) {
+    $raw_assert(from != nullptr);
+    H::ArenaChunk* prev = from->prev;
+    mi_free(from);
+    from = prev;
+  }
+}
@@ -0,0 +1,268 @@
+//===- DeferredFree.cpp ---------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+
+#include <CoreCommon/Mimalloc.hpp>
+#include <CoreCommon/Multithreaded.hpp>
+#include <Core/MimAllocator.hpp>
+
+#define MIMALLOC_BASE efl::C::H::MimAllocatorBase
+
+using namespace efl;
+using namespace efl::C;
+
+#if EFL_MULTITHREADED
+#include <atomic>
+#include <type_traits>
+#include <Core/Mtx.hpp>
+#include <mimalloc/types.h>
+
+//=== Deferred Frees ===//
+// Remote frees are chained through the blocks themselves, one
+// chain per owning thread. Full chains are pushed to the owner's
+// inbox with a single CAS, and the owner frees them locally.
+
+namespace {
+  /// Intrusive link stored in the first word of a freed block.
+  struct DeferredBlock {
+    DeferredBlock* next;
+  };
+
+  /// Chains returned to a thread by others.
+  /// Inboxes are recycled but never freed, so stale pointers
+  /// held by other threads stay valid.
+  struct DeferredInbox {
+    std::atomic<DeferredBlock*> head { nullptr };
+    std::atomic<bool> isLive { false };
+    mi_threadid_t owner = 0;
+    DeferredInbox* nextInbox = nullptr;
+  };
+
+  struct DeferredRegistry {
+    DeferredInbox* find(mi_threadid_t owner) {
+      MEflLock(mtx_);
+      for(auto* I = inboxes_; I; I = I->nextInbox) {
+        if(I->owner == owner && I->isLive.load(std::memory_order_relaxed))
+          return I;
+      }
+      return nullptr;
+    }
+
+    DeferredInbox* acquire(mi_threadid_t owner) {
+      MEflLock(mtx_);
+      DeferredInbox* inbox = inboxes_;
+      while(inbox && inbox->isLive.load(std::memory_order_relaxed))
+        inbox = inbox->nextInbox;
+      if(!inbox) {
+        inbox = new DeferredInbox;
+        inbox->nextInbox = inboxes_;
+        inboxes_ = inbox;
+      }
+      inbox->owner = owner;
+      inbox->isLive.store(true);
+      return inbox;
+    }
+
+    void release(DeferredInbox* inbox) {
+      MEflLock(mtx_);
+      inbox->isLive.store(false);
+    }
+
+  public:
+    C::Mtx mtx_;
+    DeferredInbox* inboxes_ = nullptr;
+  };
+
+  /// Blocks waiting to be returned to a single owner.
+  struct DeferredChain {
+    mi_threadid_t owner = 0;
+    DeferredInbox* inbox = nullptr;
+    DeferredBlock* head = nullptr;
+    DeferredBlock* tail = nullptr;
+    H::SzType count = 0;
+  };
+
+  constexpr H::SzType deferred_slots = 8;
+  constexpr H::SzType deferred_batch = 64;
+
+  struct DeferredState {
+    ~DeferredState();
+    void defer(void* P, mi_threadid_t owner) NOEXCEPT;
+    void flush(DeferredChain& chain) NOEXCEPT;
+    void flushAll() NOEXCEPT;
+    H::SzType collect() NOEXCEPT;
+    mi_threadid_t self() NOEXCEPT;
+  public:
+    DeferredChain chains_[deferred_slots] { };
+    DeferredInbox* inbox_ = nullptr;
+    mi_threadid_t self_ = 0;
+  };
+} // namespace `anonymous`
+
+static DeferredRegistry& deferred_registry_() {
+  static DeferredRegistry registry { };
+  return registry;
+}
+
+static EFL_THREADLOCAL DeferredState deferred_state_ { };
+
+static H::SzType deferred_slot_(mi_threadid_t owner) {
+  // Thread ids are addresses, so mix in the high bits.
+  const u64 hash = u64(owner) * 0x9E3779B97F4A7C15ULL;
+  return H::SzType(hash >> 61) % deferred_slots;
+}
+
+// The segment layout isn't public, so pin the version it matches.
+static_assert(MI_MALLOC_VERSION == 212,
+  "Check `mi_segment_t::thread_id` before updating mimalloc.");
+static_assert(std::is_same<decltype(mi_segment_t::thread_id),
+  std::atomic<mi_threadid_t>>::value,
+  "The segment owner is expected to be atomic.");
+
+/// Same as `_mi_ptr_segment`, without the debug asserts.
+/// Aligned blocks may start on a segment boundary, hence the `- 1`.
+static mi_threadid_t owner_of_(const void* P) {
+  auto* segment = reinterpret_cast<mi_segment_t*>(
+    (reinterpret_cast<uintptr_t>(P) - 1) & ~MI_SEGMENT_MASK);
+  return segment->thread_id.load(std::memory_order_relaxed);
+}
+
+static H::SzType free_chain_(DeferredBlock* B) {
+  H::SzType count = 0;
+  while(B) {
+    DeferredBlock* next = B->next;
+    mi_free(B);
+    B = next;
+    ++count;
+  }
+  return count;
+}
+
+DeferredState::~DeferredState() {
+  this->flushAll();
+  if(DeferredInbox* inbox = this->inbox_) {
+    // Producers check `isLive` after pushing, so anything
+    // pushed after this point is freed by them instead.
+    deferred_registry_().release(inbox);
+    free_chain_(inbox->head.exchange(nullptr));
+  }
+}
+
+void DeferredState::defer(void* P, mi_threadid_t owner) NOEXCEPT {
+  DeferredChain& chain = this->chains_[deferred_slot_(owner)];
+  if(chain.owner != owner) {
+    if(chain.head)
+      this->flush(chain);
+    chain.owner = owner;
+    chain.inbox = deferred_registry_().find(owner);
+    chain.count = 0;
+  }
+
+  if(EFL_UNLIKELY(!chain.inbox)) {
+    // The owner doesn't collect, check again later.
+    if(++chain.count >= deferred_batch)
+      chain.owner = 0;
+    mi_free(P);
+    return;
+  }
+
+  auto* B = static_cast<DeferredBlock*>(P);
+  B->next = chain.head;
+  chain.head = B;
+  if(!chain.tail)
+    chain.tail = B;
+  if(++chain.count >= deferred_batch)
+    this->flush(chain);
+}
+
+void DeferredState::flush(DeferredChain& chain) NOEXCEPT {
+  $raw_assert(chain.head && chain.inbox);
+  DeferredInbox* inbox = chain.inbox;
+  DeferredBlock* old = inbox->head.load(std::memory_order_relaxed);
+  do {
+    chain.tail->next = old;
+  } while(!inbox->head.compare_exchange_weak(old, chain.head));
+
+  // The owner may have exited while we were pushing.
+  if(EFL_UNLIKELY(!inbox->isLive.load())) {
+    free_chain_(inbox->head.exchange(nullptr));
+    chain.owner = 0;
+  }
+  chain.head  = nullptr;
+  chain.tail  = nullptr;
+  chain.count = 0;
+}
+
+void DeferredState::flushAll() NOEXCEPT {
+  for(DeferredChain& chain : this->chains_) {
+    if(chain.head)
+      this->flush(chain);
+    // Look up the owners again on the next free.
+    chain.owner = 0;
+  }
+}
+
+H::SzType DeferredState::collect() NOEXCEPT {
+  if(EFL_UNLIKELY(!this->inbox_))
+    this->inbox_ = deferred_registry_().acquire(this->self());
+  auto* head = this->inbox_->head.exchange(
+    nullptr, std::memory_order_acquire);
+  return free_chain_(head);
+}
+
+mi_threadid_t DeferredState::self() NOEXCEPT {
+  if(EFL_UNLIKELY(!this->self_)) {
+    // The id isn't public, but fresh blocks are always local.
+    void* P = mi_malloc(1);
+    this->self_ = owner_of_(P);
+    mi_free(P);
+  }
+  return this->self_;
+}
+
+//=== MimAllocatorBase ===//
+
+void MIMALLOC_BASE::DeallocateDeferred(void* P) {
+  if(EFL_UNLIKELY(!P)) return;
+  const mi_threadid_t owner = owner_of_(P);
+  // Local and abandoned blocks are freed right away.
+  if(owner == deferred_state_.self() || owner == 0) {
+    mi_free(P);
+    return;
+  }
+  deferred_state_.defer(P, owner);
+}
+
+void MIMALLOC_BASE::FlushDeferred() {
+  deferred_state_.flushAll();
+}
+
+H::SzType MIMALLOC_BASE::CollectDeferred() {
+  return deferred_state_.collect();
+}
+
+#else
+
+void MIMALLOC_BASE::DeallocateDeferred(void* P) 
+{ mi_free(P); }
+
+void MIMALLOC_BASE::FlushDeferred() { }
+
+H::SzType MIMALLOC_BASE::CollectDeferred() 
+{ return 0; }
+
+#endif // EFL_MULTITHREADED
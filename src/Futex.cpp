@@ -0,0 +1,77 @@
+//===- Futex.cpp ----------------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+
+#include <Core/MpmcQueue.hpp>
+
+#if defined(__linux__)
+# include <climits>
+# include <linux/futex.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# define FUTEX_NATIVE_ 1
+#else
+# include <thread>
+# define FUTEX_NATIVE_ 0
+#endif
+
+using namespace efl;
+using namespace efl::C;
+
+static_assert(sizeof(std::atomic<u32>) == sizeof(u32),
+  "futex words must be plain 32-bit integers.");
+
+#if FUTEX_NATIVE_
+static long futex_(const std::atomic<u32>* word, int op, u32 val) {
+  // The kernel only reads the word, or compares against it.
+  auto* addr = const_cast<u32*>(reinterpret_cast<const u32*>(word));
+  return ::syscall(SYS_futex, addr, op, val, nullptr, nullptr, 0);
+}
+
+void C::H::futex_wait(const std::atomic<u32>* word, u32 expected) NOEXCEPT {
+  (void) futex_(word, FUTEX_WAIT_PRIVATE, expected);
+}
+
+void C::H::futex_wake_one(const std::atomic<u32>* word) NOEXCEPT {
+  (void) futex_(word, FUTEX_WAKE_PRIVATE, 1);
+}
+
+void C::H::futex_wake_all(const std::atomic<u32>* word) NOEXCEPT {
+  (void) futex_(word, FUTEX_WAKE_PRIVATE, u32(INT_MAX));
+}
+#elif defined(__cpp_lib_atomic_wait)
+void C::H::futex_wait(const std::atomic<u32>* word, u32 expected) NOEXCEPT {
+  word->wait(expected, std::memory_order_acquire);
+}
+
+void C::H::futex_wake_one(const std::atomic<u32>* word) NOEXCEPT {
+  const_cast<std::atomic<u32>*>(word)->notify_one();
+}
+
+void C::H::futex_wake_all(const std::atomic<u32>* word) NOEXCEPT {
+  const_cast<std::atomic<u32>*>(word)->notify_all();
+}
+#else
+// No way to sleep on an address, poll instead.
+void C::H::futex_wait(const std::atomic<u32>* word, u32 expected) NOEXCEPT {
+  while(word->load(std::memory_order_acquire) == expected)
+    std::this_thread::yield();
+}
+
+void C::H::futex_wake_one(const std::atomic<u32>*) NOEXCEPT { }
+void C::H::futex_wake_all(const std::atomic<u32>*) NOEXCEPT { }
+#endif
@@ -18,6 +18,8 @@
 
 #define EFLI_MIMALLOCATOR_INTERNAL_ 1
 #include <CoreCommon/Mimalloc.hpp>
+#include <CoreCommon/Multithreaded.hpp>
+#include <Core/AllocScope.hpp>
 #include <Core/MimAllocator.hpp>
 #include <mimalloc/types.h>
 
@@ -29,33 +31,94 @@ using namespace efl::C;
 static_assert(MIMALLOC_BASE::smallAllocMax <= MI_SMALL_SIZE_MAX,
   "Incorrectly estimated the max size. Let us know about this.");
 
+/// Heap set by the innermost `AllocScope`, null when there is none.
+/// Checked before every allocation, so keep it trivial.
+static EFL_THREADLOCAL mi_heap_t* scope_heap_ = nullptr;
+
+//=== AllocScope ===//
+
+AllocScope::AllocScope(HandleType heap) NOEXCEPT 
+ : prev_(scope_heap_) {
+  scope_heap_ = heap;
+}
+
+AllocScope::~AllocScope() {
+  scope_heap_ = this->prev_;
+}
+
+AllocScope::HandleType AllocScope::Current() NOEXCEPT {
+  return scope_heap_;
+}
+
+//=== MimAllocatorBase ===//
+
 void* MIMALLOC_BASE::Allocate(H::SzType size) {
+  if(EFL_UNLIKELY(scope_heap_))
+    return mi_heap_malloc(scope_heap_, size);
   return mi_malloc(size);
 }
 
 void* MIMALLOC_BASE::Allocate(H::SzType size, void* hint) {
   (void)hint;
-  return mi_malloc(size);
+  return MIMALLOC_BASE::Allocate(size);
 }
 
 void* MIMALLOC_BASE::AllocateSmall(H::SzType size) {
   $raw_assert(size <= MIMALLOC_BASE::smallAllocMax);
+  if(EFL_UNLIKELY(scope_heap_))
+    return mi_heap_malloc_small(scope_heap_, size);
   return mi_malloc_small(size);
 }
 
 void* MIMALLOC_BASE::AllocateAligned(H::SzType align, H::SzType size) {
   $raw_assert((align <= MI_ALIGNMENT_MAX) && H::is_power_of_2(align));
+  if(EFL_UNLIKELY(scope_heap_))
+    return mi_heap_malloc_aligned(scope_heap_, size, align);
   return mi_aligned_alloc(align, size);
 }
 
+void* MIMALLOC_BASE::AllocateZeroed(H::SzType size) {
+  if(EFL_UNLIKELY(scope_heap_))
+    return mi_heap_zalloc(scope_heap_, size);
+  return mi_zalloc(size);
+}
+
+void* MIMALLOC_BASE::AllocateZeroedAligned(H::SzType align, H::SzType size) {
+  $raw_assert((align <= MI_ALIGNMENT_MAX) && H::is_power_of_2(align));
+  if(EFL_UNLIKELY(scope_heap_))
+    return mi_heap_zalloc_aligned(scope_heap_, size, align);
+  return mi_zalloc_aligned(size, align);
+}
+
 MIMALLOC_BASE::VoidAllocResult
  MIMALLOC_BASE::AllocateAtLeast(H::SzType size) {
-  return { mi_malloc(size), size };
+  // Round up to the size class, the block is that large anyways.
+  const H::SzType good_size = mi_good_size(size);
+  return { MIMALLOC_BASE::Allocate(good_size), good_size };
+}
+
+MIMALLOC_BASE::VoidAllocResult
+ MIMALLOC_BASE::AllocateAtLeastAligned(H::SzType align, H::SzType size) {
+  $raw_assert((align <= MI_ALIGNMENT_MAX) && H::is_power_of_2(align));
+  void* P = EFL_UNLIKELY(scope_heap_)
+    ? mi_heap_malloc_aligned(scope_heap_, size, align)
+    : mi_malloc_aligned(size, align);
+  // Aligned blocks may be offset, so query the real size.
+  if(EFL_UNLIKELY(!P)) return { nullptr, 0 };
+  return { P, mi_usable_size(P) };
 }
 
 void MIMALLOC_BASE::Deallocate(void* P) 
 { mi_free(P); }
 
+void MIMALLOC_BASE::DeallocateSized(void* P, H::SzType size) 
+{ mi_free_size(P, size); }
+
+void MIMALLOC_BASE::DeallocateAligned(
+ void* P, H::SzType align, H::SzType size) {
+  mi_free_size_aligned(P, size, align);
+}
+
 bool MIMALLOC_BASE::IsMallocRedirected() {
 #if defined(PLATFORM_WINDOWS)
   return mi_is_redirected();
@@ -0,0 +1,58 @@
+//===- MimConfig.cpp ------------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+
+#include <CoreCommon/Mimalloc.hpp>
+#include <Core/MimConfig.hpp>
+
+using namespace efl;
+using namespace efl::C;
+
+static const mi_option_t mim_options_[] {
+  mi_option_allow_large_os_pages,
+  mi_option_eager_commit,
+  mi_option_purge_delay,
+  mi_option_arena_reserve
+};
+
+bool MimConfig::apply() const NOEXCEPT {
+  for(u8 I = 0; I < MaxOption; ++I) {
+    if(this->set_mask_ & u8(1U << I))
+      mi_option_set(mim_options_[I], this->options_[I]);
+  }
+
+  // Does nothing if mimalloc was already initialized.
+  mi_process_init();
+  bool success = true;
+  if(this->huge_pages_ > 0) {
+    success &= (mi_reserve_huge_os_pages_interleave(
+      this->huge_pages_, this->huge_nodes_, this->huge_timeout_) == 0);
+  }
+  if(this->os_memory_ > 0) {
+    success &= (mi_reserve_os_memory(
+      this->os_memory_, this->os_commit_, 
+      this->hasLargePages()) == 0);
+  }
+  return success;
+}
+
+MimConfig MimConfig::Current() NOEXCEPT {
+  MimConfig config { };
+  for(u8 I = 0; I < MaxOption; ++I)
+    config.set(Option(I), mi_option_get(mim_options_[I]));
+  return config;
+}
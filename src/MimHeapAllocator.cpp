@@ -0,0 +1,61 @@
+//===- MimHeapAllocator.cpp -----------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+
+#include <CoreCommon/Mimalloc.hpp>
+#include <Core/MimHeapAllocator.hpp>
+#include <mimalloc/types.h>
+
+#define MIMHEAP_BASE efl::C::H::MimHeapBase
+
+using namespace efl;
+using namespace efl::C;
+
+/// Unbound allocators use the thread's default heap.
+static inline mi_heap_t* get_heap_(H::MimHeapHandle heap) {
+  if(EFL_LIKELY(heap)) return heap;
+  return mi_heap_get_default();
+}
+
+void* MIMHEAP_BASE::HeapAllocate(
+ H::MimHeapHandle heap, H::SzType size) {
+  return mi_heap_malloc(get_heap_(heap), size);
+}
+
+void* MIMHEAP_BASE::HeapAllocateAligned(
+ H::MimHeapHandle heap, H::SzType align, H::SzType size) {
+  $raw_assert((align <= MI_ALIGNMENT_MAX) && H::is_power_of_2(align));
+  return mi_heap_malloc_aligned(get_heap_(heap), size, align);
+}
+
+H::MimHeapHandle MIMHEAP_BASE::HeapNew() {
+  return mi_heap_new();
+}
+
+void MIMHEAP_BASE::HeapDelete(H::MimHeapHandle heap) {
+  $raw_assert(heap != nullptr);
+  mi_heap_delete(heap);
+}
+
+void MIMHEAP_BASE::HeapDestroy(H::MimHeapHandle heap) {
+  $raw_assert(heap != nullptr);
+  mi_heap_destroy(heap);
+}
+
+bool MIMHEAP_BASE::HeapContains(H::MimHeapHandle heap, const void* P) {
+  return mi_heap_check_owned(heap, P);
+}
@@ -0,0 +1,157 @@
+//===- NumaHeap.cpp -------------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+
+#include <CoreCommon/Mimalloc.hpp>
+#include <Core/NumaHeap.hpp>
+#include <Core/Mtx.hpp>
+
+#if defined(__linux__)
+# include <sys/syscall.h>
+# include <unistd.h>
+# include <cstdio>
+# include <cstdlib>
+# define NUMA_CAN_BIND_ 1
+#else
+# define NUMA_CAN_BIND_ 0
+#endif
+
+#if EFL_MULTITHREADED
+# define NUMA_LOCK_() MEflLock(arena_mtx_)
+#else
+# define NUMA_LOCK_() (void)(0)
+#endif
+
+using namespace efl;
+using namespace efl::C;
+
+namespace {
+  constexpr H::SzType max_nodes_ = 64;
+
+  struct NumaArena {
+    bool initialized = false;
+    bool reserved = false;
+    mi_arena_id_t id = 0;
+  };
+
+  C::Mtx arena_mtx_ { };
+  NumaArena arenas_[max_nodes_] { };
+} // namespace `anonymous`
+
+/// Prefers `node` for every page in the arena. 
+/// Failing is fine, the memory is still usable.
+static void bind_arena_(mi_arena_id_t id, int node) {
+#if NUMA_CAN_BIND_
+  constexpr unsigned long mpol_preferred = 1;
+  H::SzType size = 0;
+  void* start = mi_arena_area(id, &size);
+  if(EFL_UNLIKELY(!start)) return;
+  unsigned long mask = 1UL << unsigned(node);
+  (void) syscall(SYS_mbind, start, size, 
+    mpol_preferred, &mask, 8 * sizeof(mask), 0);
+#else
+  (void) id;
+  (void) node;
+#endif
+}
+
+/// Gets the arena for `node`, reserving it if needed.
+static NumaArena* get_arena_(int node, usize size) {
+  if(EFL_UNLIKELY(H::SzType(node) >= max_nodes_)) 
+    return nullptr;
+  NUMA_LOCK_();
+  NumaArena& arena = arenas_[node];
+  if(!arena.initialized) {
+    arena.initialized = true;
+    // Reserve only, pages are committed on first touch.
+    const int err = mi_reserve_os_memory_ex(
+      size, false, false, true, &arena.id);
+    if(err == 0) {
+      bind_arena_(arena.id, node);
+      arena.reserved = true;
+    }
+  }
+  return arena.reserved ? &arena : nullptr;
+}
+
+/// The highest possible node index, plus one.
+static usize detect_numa_nodes_() {
+#if NUMA_CAN_BIND_
+  // A list of ranges, eg. "0" or "0-1,4-5". Node numbers may
+  // have gaps, so take the last index rather than counting.
+  std::FILE* file = 
+    std::fopen("/sys/devices/system/node/possible", "r");
+  if(!file) return 1;
+  char buf[256] { };
+  const bool read = std::fgets(buf, sizeof(buf), file) != nullptr;
+  std::fclose(file);
+  if(!read) return 1;
+  usize last = 0;
+  for(const char* P = buf; *P; ++P) {
+    if(*P < '0' || *P > '9') continue;
+    char* end = nullptr;
+    last = usize(std::strtoul(P, &end, 10));
+    P = end - 1;
+  }
+  return last + 1;
+#else
+  return 1;
+#endif
+}
+
+/// Detects the nodes, capped by `use_numa_nodes`.
+static usize count_numa_nodes_() {
+  const usize detected = detect_numa_nodes_();
+  const long cap = mi_option_get(mi_option_use_numa_nodes);
+  if(cap > 0 && usize(cap) < detected)
+    return usize(cap);
+  return detected;
+}
+
+usize C::numa_node_count() NOEXCEPT {
+  static const usize count = count_numa_nodes_();
+  return count;
+}
+
+int C::current_numa_node() NOEXCEPT {
+  const usize count = numa_node_count();
+  if(count <= 1) return 0;
+#if NUMA_CAN_BIND_
+  unsigned cpu = 0, node = 0;
+  if(syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+    return 0;
+  return int(node % count);
+#else
+  return 0;
+#endif
+}
+
+NumaHeap::NumaHeap(int node, usize arena_size) {
+  if(node == currentNode)
+    node = current_numa_node();
+  this->node_ = node;
+  // Degrade to the default heap.
+  if(numa_node_count() <= 1 || !NUMA_CAN_BIND_) 
+    return;
+  if(NumaArena* arena = get_arena_(node, arena_size))
+    this->heap_ = MimHeap(mi_heap_new_in_arena(arena->id));
+}
+
+H::MimHeapHandle H::thread_numa_heap() {
+  static EFL_THREADLOCAL NumaHeap heap { };
+  return heap.heap().get();
+}
@@ -0,0 +1,95 @@
+//===- PoolBoxAllocator.cpp -----------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+
+#include <CoreCommon/Mimalloc.hpp>
+#include <Core/PoolBoxAllocator.hpp>
+
+#if EFL_MULTITHREADED
+# define POOL_LOCK_(shared) MEflLock((shared).mtx_)
+#else
+# define POOL_LOCK_(shared) (void)(0)
+#endif
+
+using namespace efl;
+using namespace efl::C;
+
+static H::SzType slab_size_(H::SzType block_size) {
+  H::SzType count = H::pool_min_slab / block_size;
+  if(count < H::pool_min_blocks)
+    count = H::pool_min_blocks;
+  return count * block_size;
+}
+
+H::PoolShared::PoolShared(SzType size, SzType align) NOEXCEPT :
+ blockSize(size), 
+ slabAlign((align > pool_cacheline) ? align : pool_cacheline),
+ slabSize(slab_size_(size)), 
+ cacheMax(std::ptrdiff_t(2 * (slab_size_(size) / size))) {
+}
+
+H::PoolCache::~PoolCache() {
+  // Carve what's left of the slab so it can be reused.
+  while(this->cur_ != this->end_) {
+    auto* B = reinterpret_cast<PoolBlock*>(this->cur_);
+    B->next = this->head_;
+    this->head_ = B;
+    this->cur_ += shared_->blockSize;
+    ++this->frees_;
+  }
+  if(this->head_)
+    this->flush();
+}
+
+void* H::PoolCache::refill() NOEXCEPT {
+  PoolShared& shared = *this->shared_;
+  {
+    POOL_LOCK_(shared);
+    // Take the most recently returned batch.
+    if(PoolBlock* batch = shared.batches_) {
+      shared.batches_ = batch->nextBatch;
+      this->head_ = batch;
+    }
+  }
+
+  if(PoolBlock* B = this->head_) {
+    // Carry the batch length over, so the next flush is bounded.
+    this->frees_ = B->next ? B->next->batchSize : 1;
+    return this->allocate();
+  }
+  
+  void* slab = mi_malloc_aligned(shared.slabSize, shared.slabAlign);
+  if(EFL_UNLIKELY(!slab)) return nullptr;
+  this->cur_ = static_cast<ubyte*>(slab) + shared.blockSize;
+  this->end_ = static_cast<ubyte*>(slab) + shared.slabSize;
+  return slab;
+}
+
+void H::PoolCache::flush() NOEXCEPT {
+  PoolShared& shared = *this->shared_;
+  $raw_assert(this->head_ != nullptr);
+  if(PoolBlock* B = this->head_->next)
+    B->batchSize = this->frees_;
+  {
+    POOL_LOCK_(shared);
+    // Push the whole list as a single batch.
+    this->head_->nextBatch = shared.batches_;
+    shared.batches_ = this->head_;
+  }
+  this->head_  = nullptr;
+  this->frees_ = 0;
+}
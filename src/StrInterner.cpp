@@ -0,0 +1,125 @@
+//===- StrInterner.cpp ----------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+
+#include <CoreCommon/Mimalloc.hpp>
+#include <Core/StrInterner.hpp>
+#include <cstring>
+
+#if EFL_MULTITHREADED
+# define SHARD_LOCK_(shard) MEflLock((shard).mtx_)
+#else
+# define SHARD_LOCK_(shard) (void)(0)
+#endif
+
+using namespace efl;
+using namespace efl::C;
+
+/// Copies `str` into `arena`, with a null terminator.
+static StrRef copy_str_(Arena& arena, StrRef str) {
+  const auto size = str.size();
+  auto* data = static_cast<char*>(arena.allocate(size + 1, 1));
+  $raw_assert(data != nullptr);
+  if(size)
+    std::memcpy(data, str.data(), size);
+  data[size] = '\0';
+  return StrRef(data, size);
+}
+
+//=== SymbolTable ===//
+
+C::H::SymbolTable::~SymbolTable() {
+  for(auto& bucket : this->buckets_)
+    mi_free(bucket.load(std::memory_order_relaxed));
+}
+
+void C::H::SymbolTable::set(u32 id, StrRef str) {
+  const u64 v = u64(id) + (u64(1) << baseShift);
+  const u32 B = u32(bit_width(v)) - (baseShift + 1);
+  StrRef* bucket = buckets_[B].load(std::memory_order_acquire);
+  if(EFL_UNLIKELY(!bucket))
+    bucket = this->allocateBucket(B);
+  bucket[v - (u64(1) << (B + baseShift))] = str;
+}
+
+StrRef* C::H::SymbolTable::allocateBucket(u32 B) {
+  const size_type count = size_type(1) << (B + baseShift);
+  auto* bucket = static_cast<StrRef*>(
+    mi_malloc_aligned(count * sizeof(StrRef), alignof(StrRef)));
+  $raw_assert(bucket != nullptr);
+  StrRef* expected = nullptr;
+  if(buckets_[B].compare_exchange_strong(expected, bucket,
+   std::memory_order_acq_rel, std::memory_order_acquire))
+    return bucket;
+  // Another shard got here first.
+  mi_free(bucket);
+  return expected;
+}
+
+//=== StrInterner ===//
+
+StrInterner::StrInterner() {
+  (void) this->intern(StrRef(""));
+}
+
+Symbol StrInterner::intern(StrRef str) {
+  auto it = map_.find(str);
+  if(EFL_LIKELY(it != map_.end()))
+    return Symbol(it->second);
+  const u32 id = this->size_++;
+  $raw_assert(this->size_ != 0);
+  const StrRef stored = copy_str_(this->arena_, str);
+  this->table_.set(id, stored);
+  (void) this->map_.tryEmplace(stored, id);
+  return Symbol(id);
+}
+
+Option<Symbol> StrInterner::find(StrRef str) const {
+  auto it = map_.find(str);
+  if(it == map_.end())
+    return Option<Symbol> {};
+  return Option<Symbol> { Symbol(it->second) };
+}
+
+//=== SyncStrInterner ===//
+
+SyncStrInterner::SyncStrInterner() {
+  (void) this->intern(StrRef(""));
+}
+
+Symbol SyncStrInterner::intern(StrRef str) {
+  Shard& shard = this->shardFor(Hash<StrRef>{}(str));
+  SHARD_LOCK_(shard);
+  auto it = shard.map_.find(str);
+  if(EFL_LIKELY(it != shard.map_.end()))
+    return Symbol(it->second);
+  const u32 id = next_id_.fetch_add(1, std::memory_order_relaxed);
+  $raw_assert(id != ~u32(0));
+  const StrRef stored = copy_str_(shard.arena_, str);
+  this->table_.set(id, stored);
+  (void) shard.map_.tryEmplace(stored, id);
+  return Symbol(id);
+}
+
+Option<Symbol> SyncStrInterner::find(StrRef str) {
+  Shard& shard = this->shardFor(Hash<StrRef>{}(str));
+  SHARD_LOCK_(shard);
+  auto it = shard.map_.find(str);
+  if(it == shard.map_.end())
+    return Option<Symbol> {};
+  return Option<Symbol> { Symbol(it->second) };
+}
@@ -0,0 +1,328 @@
+//===- StrSearch.cpp ------------------------------------------------===//
+//
+// Copyright (C) 2024 Eightfold
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//===----------------------------------------------------------------===//
+//
+//  This file implements the vectorized StrRef search kernels.
+//  SSE2 is always used on x86-64, AVX2 when the CPU supports it.
+//
+//===----------------------------------------------------------------===//
+
+#include <Core/StrRef.hpp>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__linux__) && \
+ (defined(__GNUC__) || defined(__clang__))
+# include <immintrin.h>
+# define STRSEARCH_X86_ 1
+# define AVX2_FN_ __attribute__((target("avx2")))
+#else
+# define STRSEARCH_X86_ 0
+#endif
+
+using namespace efl;
+using namespace efl::C;
+using SzType = C::H::SzType;
+
+static constexpr SzType npos_ = StrRef::npos;
+
+ALWAYS_INLINE static SzType offset_(SzType n, SzType pos) {
+  return (n == npos_) ? npos_ : n + pos;
+}
+
+/// Scans for the first character, then compares the rest.
+static SzType find_scalar_(const char* s, SzType n,
+ const char* t, SzType k) NOEXCEPT {
+  const char* p = s;
+  const char* const end = s + (n - k + 1);
+  while(p < end) {
+    p = static_cast<const char*>(
+      std::memchr(p, t[0], SzType(end - p)));
+    if(p == nullptr) break;
+    if(std::memcmp(p + 1, t + 1, k - 1) == 0)
+      return SzType(p - s);
+    ++p;
+  }
+  return npos_;
+}
+
+#if STRSEARCH_X86_
+static bool detect_avx2_() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+/// Zero until static init runs, which only means SSE2 is used.
+static const bool has_avx2_ = detect_avx2_();
+
+ALWAYS_INLINE static int ctz_(u32 mask) {
+  return __builtin_ctz(mask);
+}
+
+ALWAYS_INLINE static int msb_(u32 mask) {
+  return 31 - __builtin_clz(mask);
+}
+
+//=== SSE2 ===//
+
+static SzType rfind_char_sse2_(
+ const char* s, SzType n, char c) NOEXCEPT {
+  if(n < 16)
+    return C::H::cxpr_rfind_char(s, n, c);
+  const __m128i needle = _mm_set1_epi8(c);
+  SzType I = n;
+  for(; I >= 16; I -= 16) {
+    const __m128i block = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(s + I - 16));
+    const u32 mask = u32(_mm_movemask_epi8(
+      _mm_cmpeq_epi8(block, needle)));
+    if(mask != 0) return I - 16 + msb_(mask);
+  }
+  if(I == 0) return npos_;
+  const __m128i block = _mm_loadu_si128(
+    reinterpret_cast<const __m128i*>(s));
+  const u32 mask = u32(_mm_movemask_epi8(
+    _mm_cmpeq_epi8(block, needle)));
+  return (mask != 0) ? SzType(msb_(mask)) : npos_;
+}
+
+static SzType find_sse2_(const char* s, SzType n,
+ const char* t, SzType k) NOEXCEPT {
+  if(n < k + 15)
+    return find_scalar_(s, n, t, k);
+  const __m128i first = _mm_set1_epi8(t[0]);
+  const __m128i last = _mm_set1_epi8(t[k - 1]);
+  const SzType stop = n - k - 15;
+  for(SzType I = 0;; I += 16) {
+    // The last block overlaps, skip candidates already checked.
+    SzType skip = 0;
+    if(I > stop) {
+      skip = I - stop;
+      I = stop;
+    }
+    const __m128i bf = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(s + I));
+    const __m128i bl = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(s + I + k - 1));
+    u32 mask = u32(_mm_movemask_epi8(_mm_and_si128(
+      _mm_cmpeq_epi8(bf, first), _mm_cmpeq_epi8(bl, last))));
+    mask &= (~u32(0) << skip);
+    while(mask != 0) {
+      const SzType at = I + ctz_(mask);
+      if(std::memcmp(s + at + 1, t + 1, k - 2) == 0)
+        return at;
+      mask &= (mask - 1);
+    }
+    if(I == stop) return npos_;
+  }
+}
+
+static SzType count_char_sse2_(
+ const char* s, SzType n, char c) NOEXCEPT {
+  const __m128i needle = _mm_set1_epi8(c);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i total = zero;
+  SzType I = 0;
+  while(I + 16 <= n) {
+    // Byte counters saturate after 255 blocks.
+    const SzType end = std::min(n - 15, I + 255 * 16);
+    __m128i acc = zero;
+    for(; I < end; I += 16) {
+      const __m128i block = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(s + I));
+      acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(block, needle));
+    }
+    total = _mm_add_epi64(total, _mm_sad_epu8(acc, zero));
+  }
+  const SzType count = SzType(_mm_cvtsi128_si64(total))
+    + SzType(_mm_cvtsi128_si64(_mm_unpackhi_epi64(total, total)));
+  return count + C::H::cxpr_count_char(s + I, n - I, c);
+}
+
+//=== AVX2 ===//
+
+AVX2_FN_ static SzType rfind_char_avx2_(
+ const char* s, SzType n, char c) NOEXCEPT {
+  const __m256i needle = _mm256_set1_epi8(c);
+  SzType I = n;
+  for(; I >= 32; I -= 32) {
+    const __m256i block = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(s + I - 32));
+    const u32 mask = u32(_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(block, needle)));
+    if(mask != 0) return I - 32 + msb_(mask);
+  }
+  if(I == 0) return npos_;
+  // Overlaps checked bytes, so only keep the first `I`.
+  const __m256i block = _mm256_loadu_si256(
+    reinterpret_cast<const __m256i*>(s));
+  const u32 mask = u32(_mm256_movemask_epi8(
+    _mm256_cmpeq_epi8(block, needle))) & ((u32(1) << I) - 1);
+  return (mask != 0) ? SzType(msb_(mask)) : npos_;
+}
+
+AVX2_FN_ static SzType find_avx2_(const char* s, SzType n,
+ const char* t, SzType k) NOEXCEPT {
+  if(n < k + 31)
+    return find_sse2_(s, n, t, k);
+  const __m256i first = _mm256_set1_epi8(t[0]);
+  const __m256i last = _mm256_set1_epi8(t[k - 1]);
+  const SzType stop = n - k - 31;
+  for(SzType I = 0;; I += 32) {
+    SzType skip = 0;
+    if(I > stop) {
+      skip = I - stop;
+      I = stop;
+    }
+    const __m256i bf = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(s + I));
+    const __m256i bl = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(s + I + k - 1));
+    u32 mask = u32(_mm256_movemask_epi8(_mm256_and_si256(
+      _mm256_cmpeq_epi8(bf, first), 
+      _mm256_cmpeq_epi8(bl, last))));
+    mask &= (~u32(0) << skip);
+    while(mask != 0) {
+      const SzType at = I + ctz_(mask);
+      if(std::memcmp(s + at + 1, t + 1, k - 2) == 0)
+        return at;
+      mask &= (mask - 1);
+    }
+    if(I == stop) return npos_;
+  }
+}
+
+/// Byte set lookup with nibble shuffles. Each byte selects a
+/// table row with its low nibble, and a bit with its high one.
+AVX2_FN_ static SzType find_of_avx2_(
+ const char* s, SzType n, const u8* table) NOEXCEPT {
+  const __m256i lo_rows = _mm256_broadcastsi128_si256(
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+  const __m256i hi_rows = _mm256_broadcastsi128_si256(
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(table + 16)));
+  const __m256i bits = _mm256_setr_epi8(
+    1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+    1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  SzType I = 0;
+  for(; I + 32 <= n; I += 32) {
+    const __m256i block = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(s + I));
+    const __m256i lo = _mm256_and_si256(block, nibble);
+    const __m256i hi = _mm256_and_si256(
+      _mm256_srli_epi16(block, 4), nibble);
+    // The top bit of each byte picks the high table.
+    const __m256i row = _mm256_blendv_epi8(
+      _mm256_shuffle_epi8(lo_rows, lo),
+      _mm256_shuffle_epi8(hi_rows, lo), block);
+    const __m256i bit = _mm256_shuffle_epi8(bits, hi);
+    const u32 mask = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+      _mm256_and_si256(row, bit), bit)));
+    if(mask != 0) return I + ctz_(mask);
+  }
+  return offset_(C::H::cxpr_find_of(s + I, n - I, table), I);
+}
+
+AVX2_FN_ static SzType count_char_avx2_(
+ const char* s, SzType n, char c) NOEXCEPT {
+  const __m256i needle = _mm256_set1_epi8(c);
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i total = zero;
+  SzType I = 0;
+  while(I + 32 <= n) {
+    const SzType end = std::min(n - 31, I + 255 * 32);
+    __m256i acc = zero;
+    for(; I < end; I += 32) {
+      const __m256i block = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(s + I));
+      acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(block, needle));
+    }
+    total = _mm256_add_epi64(total, _mm256_sad_epu8(acc, zero));
+  }
+  alignas(32) u64 lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+  const SzType count = 
+    SzType(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+  // Avoids AVX to SSE transition stalls in the tail.
+  _mm256_zeroupper();
+  return count + count_char_sse2_(s + I, n - I, c);
+}
+#endif // STRSEARCH_X86_
+
+//=== Dispatch ===//
+
+SzType C::H::str_find_char(const char* s, SzType n, char c) NOEXCEPT {
+  // libc already dispatches to the widest vector unit here.
+  const void* at = std::memchr(s, c, n);
+  return at ? SzType(static_cast<const char*>(at) - s) : npos_;
+}
+
+SzType C::H::str_rfind_char(const char* s, SzType n, char c) NOEXCEPT {
+#if STRSEARCH_X86_
+  if(has_avx2_ && n >= 32)
+    return rfind_char_avx2_(s, n, c);
+  return rfind_char_sse2_(s, n, c);
+#else
+  return C::H::cxpr_rfind_char(s, n, c);
+#endif
+}
+
+SzType C::H::str_find(const char* s, SzType n,
+ const char* t, SzType k) NOEXCEPT {
+  if(k == 1)
+    return C::H::str_find_char(s, n, t[0]);
+#if STRSEARCH_X86_
+  if(has_avx2_)
+    return find_avx2_(s, n, t, k);
+  return find_sse2_(s, n, t, k);
+#else
+  return find_scalar_(s, n, t, k);
+#endif
+}
+
+SzType C::H::str_rfind(const char* s, SzType n,
+ const char* t, SzType k) NOEXCEPT {
+  // Walks back over candidates for the first character.
+  SzType end = n - k + 1;
+  while(end != 0) {
+    const SzType at = C::H::str_rfind_char(s, end, t[0]);
+    if(at == npos_) break;
+    if(std::memcmp(s + at + 1, t + 1, k - 1) == 0)
+      return at;
+    end = at;
+  }
+  return npos_;
+}
+
+SzType C::H::str_find_of(const char* s, SzType n,
+ const u8* table) NOEXCEPT {
+#if STRSEARCH_X86_
+  if(has_avx2_ && n >= 32)
+    return find_of_avx2_(s, n, table);
+#endif
+  return C::H::cxpr_find_of(s, n, table);
+}
+
+SzType C::H::str_count_char(const char* s, SzType n, char c) NOEXCEPT {
+#if STRSEARCH_X86_
+  if(has_avx2_)
+    return count_char_avx2_(s, n, c);
+  return count_char_sse2_(s, n, c);
+#else
+  return C::H::cxpr_count_char(s, n, c);
+#endif
+}